@@ -0,0 +1,156 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Small benchmark registry and driver.
+ *
+ * Each benchmark registers a setup function under a unique name.  The setup
+ * runs once (and only if the benchmark was selected), builds whatever data
+ * it needs, may add counters (errors, sizes, ...) and a label to the report
+ * and returns the function that performs the measured operation a given
+ * number of times:
+ *
+ *   registerBenchmark("impls/normal", [](BenchmarkReport &) -> BenchmarkFunction
+ *   {
+ *     auto vals = std::make_shared<std::vector<Real>>(NumValues);
+ *     return [vals](unsigned long iterations) { ... };
+ *   }).items(NumValues);
+ *
+ * The test_*.C files do their registration from a static initializer.
+ *
+ * runBenchmarks() calibrates the iteration count so one repetition takes at
+ * least --min-time seconds, runs the warmups and repetitions and reports
+ * min / median / mean / stddev of the time per iteration.
+ */
+
+/// Runs the measured operation iterations times
+typedef std::function<void(unsigned long iterations)> BenchmarkFunction;
+
+/// Extra information reported next to the timings
+struct BenchmarkReport
+{
+  /// Named values, e.g. the measured error
+  std::map<std::string, double> counters;
+
+  /// Free form note, e.g. which instruction set was used
+  std::string label;
+};
+
+/**
+ * Prepares a benchmark and returns the function to time.
+ * Throwing a std::exception skips the benchmark.
+ */
+typedef std::function<BenchmarkFunction(BenchmarkReport & report)> BenchmarkSetup;
+
+class Benchmark
+{
+public:
+  Benchmark(const std::string & name, BenchmarkSetup setup) : _name(name), _setup(setup) {}
+
+  /// Work items (values, segments, ...) processed per iteration, for the throughput column
+  Benchmark & items(double items_per_iteration)
+  {
+    _items = items_per_iteration;
+    return *this;
+  }
+
+  /// Bytes moved per iteration, for the bandwidth column
+  Benchmark & bytes(double bytes_per_iteration)
+  {
+    _bytes = bytes_per_iteration;
+    return *this;
+  }
+
+  /// Use a fixed iteration count instead of calibrating (for very long running benchmarks)
+  Benchmark & iterations(unsigned long fixed_iterations)
+  {
+    _iterations = fixed_iterations;
+    return *this;
+  }
+
+  const std::string & name() const { return _name; }
+
+  double itemsPerIteration() const { return _items; }
+
+  double bytesPerIteration() const { return _bytes; }
+
+  unsigned long fixedIterations() const { return _iterations; }
+
+  BenchmarkFunction setup(BenchmarkReport & report) const { return _setup(report); }
+
+protected:
+  std::string _name;
+
+  BenchmarkSetup _setup;
+
+  double _items = 0;
+
+  double _bytes = 0;
+
+  unsigned long _iterations = 0;
+};
+
+/**
+ * Add a benchmark to the global registry.  Names must be unique.
+ */
+Benchmark & registerBenchmark(const std::string & name, BenchmarkSetup setup);
+
+/// Command line settings for runBenchmarks()
+struct BenchmarkOptions
+{
+  /// Regular expressions, a benchmark runs if its name matches any of them (all if empty)
+  std::vector<std::string> filters;
+
+  /// Only print the names of the selected benchmarks
+  bool list = false;
+
+  /// Untimed runs after calibration
+  unsigned int warmup = 1;
+
+  /// Timed runs the statistics are computed from
+  unsigned int repetitions = 5;
+
+  /// Minimum seconds per repetition when calibrating
+  double min_time = 0.2;
+
+  /// "table", "csv" or "json"
+  std::string format = "table";
+
+  /// Write the report here instead of stdout
+  std::string output;
+
+  /**
+   * Name of a lower-is-better counter (e.g. an error): results that carry it
+   * get a "pareto" counter that is 1 if no other such result is both faster
+   * and has a lower value
+   */
+  std::string pareto;
+};
+
+/**
+ * Parse the benchmark driver's command line; prints usage and exits on --help
+ * or an unknown option
+ */
+BenchmarkOptions parseBenchmarkOptions(int argc, char ** argv);
+
+/**
+ * Run every registered benchmark selected by options.
+ * @return Process exit code
+ */
+int runBenchmarks(const BenchmarkOptions & options);
+
+/**
+ * Keep the compiler from optimizing away a value a benchmark computes
+ */
+template <typename T>
+inline void doNotOptimize(T const & value)
+{
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif
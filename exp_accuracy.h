@@ -0,0 +1,68 @@
+#ifndef EXP_ACCURACY_H
+#define EXP_ACCURACY_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Accuracy checks for the exp implementations against a long double reference.
+ *
+ * An ExpDomain describes the inputs: a dense even sweep and uniformly random
+ * points over [lo, hi], plus adversarial points that are clipped to the domain:
+ * the points around (k + 1/2) ln2 where rounding x / ln2 switches k in the range
+ * reduction, the multiples k ln2 (reduced argument ~ 0), the overflow / underflow
+ * thresholds and tiny arguments around 0.
+ */
+struct ExpDomain
+{
+  std::string name;
+
+  double lo;
+
+  double hi;
+
+  /// Evenly spaced points over [lo, hi]
+  unsigned long dense_points = 1000000;
+
+  /// Uniformly random points over [lo, hi]
+  unsigned long random_points = 1000000;
+
+  /// Include the range reduction boundaries etc. (see above)
+  bool adversarial = true;
+
+  unsigned long seed = 42;
+};
+
+/// The inputs described by domain
+std::vector<double> expDomainPoints(const ExpDomain & domain);
+
+/// Error of one implementation over a set of inputs
+struct ExpAccuracy
+{
+  /// Largest error in units in the last place of the correctly rounded result
+  double max_ulp = 0;
+
+  double mean_ulp = 0;
+
+  /// Largest |result - reference| / reference
+  double max_rel_error = 0;
+
+  /// Input that produced max_ulp
+  double worst_input = 0;
+};
+
+/// Computes exp of a whole array like the functions in impls.h
+typedef std::function<void(std::vector<double> & in, std::vector<double> & out)> ArrayExpFunction;
+
+/**
+ * Error in ULPs of exp(x) computed by function for every x in inputs
+ * against std::exp((long double)x).  A non-finite result where the
+ * reference is finite counts as an infinite error.
+ */
+ExpAccuracy measureExpAccuracy(const ArrayExpFunction & function, std::vector<double> inputs);
+
+/// Error in ULPs of result as an approximation of reference
+double ulpError(double result, long double reference);
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef EXP_ATTENUATION_H
+#define EXP_ATTENUATION_H
+
+// Include after vectorclass.h so MAX_VECTOR_SIZE is already settled
+#include "vecmath/vectormath_exp.h"
+
+#ifdef VCL_NAMESPACE
+namespace VCL_NAMESPACE {
+#endif
+
+// Fused 1 - exp(-tau) for optical thickness tau >= 0
+//
+// Same reduction and polynomial as the expm1 path of exp_d / exp_f in
+// vecmath/vectormath_exp.h, but:
+//  - The result comes straight out of expm1 form, so there is no
+//    cancellation in 1 - exp(-tau) for small tau
+//  - Only non-negative, finite tau is supported.  Very large tau is clamped
+//    (the result is 1) and there is no overflow / INF / NAN handling
+//
+// Template parameters:
+// VTYPE:  double vector type
+
+template<class VTYPE>
+static inline VTYPE one_minus_exp_neg_d(VTYPE const & tau) {
+
+    // Taylor coefficients, 1/n!
+    const double p2  = 1./2.;
+    const double p3  = 1./6.;
+    const double p4  = 1./24.;
+    const double p5  = 1./120.;
+    const double p6  = 1./720.;
+    const double p7  = 1./5040.;
+    const double p8  = 1./40320.;
+    const double p9  = 1./362880.;
+    const double p10 = 1./3628800.;
+    const double p11 = 1./39916800.;
+    const double p12 = 1./479001600.;
+    const double p13 = 1./6227020800.;
+
+    // Below this 2^r is no longer a normal number (and exp(-tau) is far below 1 ulp of 1)
+    const double min_x = -708.39;
+
+    const double ln2d_hi = 0.693145751953125;
+    const double ln2d_lo = 1.42860682030941723212E-6;
+
+    // data vectors
+    VTYPE  x, r, z, n2;
+
+    x = max(-tau, VTYPE(min_x));
+    r = round(x*VM_LOG2E);
+    // subtraction in two steps for higher precision
+    x = nmul_add(r, ln2d_hi, x);                 //  x -= r * ln2d_hi;
+    x = nmul_add(r, ln2d_lo, x);                 //  x -= r * ln2d_lo;
+
+    z = polynomial_13m(x, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13);
+
+    // multiply by power of 2
+    n2 = vm_pow2n(r);
+
+    // 1 - exp(-tau) = -expm1(x) = (1 - n2) - z * n2
+    return nmul_add(z, n2, 1.0 - n2);
+}
+
+// Template parameters:
+// VTYPE:  float vector type
+template<class VTYPE>
+static inline VTYPE one_minus_exp_neg_f(VTYPE const & tau) {
+
+    // Taylor coefficients
+    const float P0expf   =  1.f/2.f;
+    const float P1expf   =  1.f/6.f;
+    const float P2expf   =  1.f/24.f;
+    const float P3expf   =  1.f/120.f;
+    const float P4expf   =  1.f/720.f;
+    const float P5expf   =  1.f/5040.f;
+
+    const float min_x = -87.3f;
+
+    const float ln2f_hi  =  0.693359375f;
+    const float ln2f_lo  = -2.12194440e-4f;
+
+    VTYPE  x, r, x2, z, n2;                      // data vectors
+
+    x = max(-tau, VTYPE(min_x));
+    r = round(x*float(VM_LOG2E));
+    x = nmul_add(r, VTYPE(ln2f_hi), x);          //  x -= r * ln2f_hi;
+    x = nmul_add(r, VTYPE(ln2f_lo), x);          //  x -= r * ln2f_lo;
+
+    x2 = x * x;
+    z = polynomial_5(x,P0expf,P1expf,P2expf,P3expf,P4expf,P5expf);
+    z = mul_add(z, x2, x);                       // z *= x2;  z += x;
+
+    // multiply by power of 2
+    n2 = vm_pow2n(r);
+
+    // 1 - exp(-tau) = -expm1(x) = (1 - n2) - z * n2
+    return nmul_add(z, n2, 1.0f - n2);
+}
+
+// instances of one_minus_exp_neg templates
+static inline Vec2d one_minus_exp_neg(Vec2d const & tau) {
+    return one_minus_exp_neg_d(tau);
+}
+
+static inline Vec4f one_minus_exp_neg(Vec4f const & tau) {
+    return one_minus_exp_neg_f(tau);
+}
+
+#if MAX_VECTOR_SIZE >= 256
+
+static inline Vec4d one_minus_exp_neg(Vec4d const & tau) {
+    return one_minus_exp_neg_d(tau);
+}
+
+static inline Vec8f one_minus_exp_neg(Vec8f const & tau) {
+    return one_minus_exp_neg_f(tau);
+}
+
+#endif // MAX_VECTOR_SIZE >= 256
+
+#if MAX_VECTOR_SIZE >= 512
+
+static inline Vec8d one_minus_exp_neg(Vec8d const & tau) {
+    return one_minus_exp_neg_d(tau);
+}
+
+static inline Vec16f one_minus_exp_neg(Vec16f const & tau) {
+    return one_minus_exp_neg_f(tau);
+}
+
+#endif // MAX_VECTOR_SIZE >= 512
+
+#ifdef VCL_NAMESPACE
+}
+#endif
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef EXP_DISPATCH_H
+#define EXP_DISPATCH_H
+
+/**
+ * Array exp with the kernel chosen at runtime from the instruction sets
+ * the CPU actually supports (see vecmath/dispatch_example.cpp).
+ *
+ * exp_dispatch.C is compiled once per instruction set, each time with its
+ * own VCL_NAMESPACE so inline vector class code for different targets can't
+ * get merged by the linker.  See build_gcc for the required objects.
+ *
+ * Nothing in here may mention a vector type: this header is shared by all of
+ * the per-instruction-set compiles.
+ */
+
+/// Signature shared by every instruction set specific kernel
+typedef void DispatchedExpFunc(const double * in, double * out, unsigned long size);
+
+/**
+ * Compute out[i] = exp(in[i]) for size values.
+ * The first call detects the CPU and binds the fastest available kernel.
+ */
+void dispatchedExp(const double * in, double * out, unsigned long size);
+
+/**
+ * Name of the instruction set the dispatcher picked ("SSE2", "AVX2" or "AVX512").
+ * Forces the detection if dispatchedExp() hasn't been called yet.
+ */
+const char * dispatchedExpInstructionSet();
+
+#endif
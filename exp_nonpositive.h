@@ -0,0 +1,158 @@
+#ifndef EXP_NONPOSITIVE_H
+#define EXP_NONPOSITIVE_H
+
+// Include after vectorclass.h so MAX_VECTOR_SIZE is already settled
+#include "vecmath/vectormath_exp.h"
+
+#ifdef EXP_NONPOSITIVE_DEBUG
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+// Abort on positive or NAN lanes with EXP_NONPOSITIVE_DEBUG, nothing otherwise
+#ifdef EXP_NONPOSITIVE_DEBUG
+#define EXP_NONPOSITIVE_CHECK(initial_x, zero)                                              \
+  if (horizontal_or((initial_x) > (zero) | is_nan(initial_x)))                              \
+  {                                                                                         \
+    std::fprintf(stderr, "exp_nonpositive() needs x <= 0, got a positive or NAN input\n"); \
+    std::abort();                                                                           \
+  }
+#else
+#define EXP_NONPOSITIVE_CHECK(initial_x, zero)
+#endif
+
+#ifdef VCL_NAMESPACE
+namespace VCL_NAMESPACE {
+#endif
+
+// exp(x) for x <= 0 only, as in MOC where x = -sigma_t * l / sin(theta)
+//
+// Same reduction and polynomial as exp_d / exp_f in vecmath/vectormath_exp.h
+// without the overflow / INF / NAN checks: anything below the underflow limit
+// returns 0 and there is no horizontal test or branch.  Positive or NAN input
+// gives garbage.  Building with -D EXP_NONPOSITIVE_DEBUG checks every vector
+// and aborts on such input, whether or not NDEBUG is defined.
+//
+// Template parameters:
+// VTYPE:  double vector type
+// BVTYPE: boolean vector type
+template<class VTYPE, class BVTYPE>
+static inline VTYPE exp_nonpositive_d(VTYPE const & initial_x) {
+
+    EXP_NONPOSITIVE_CHECK(initial_x, 0.)
+
+    // Taylor coefficients, 1/n!
+    const double p2  = 1./2.;
+    const double p3  = 1./6.;
+    const double p4  = 1./24.;
+    const double p5  = 1./120.;
+    const double p6  = 1./720.;
+    const double p7  = 1./5040.;
+    const double p8  = 1./40320.;
+    const double p9  = 1./362880.;
+    const double p10 = 1./3628800.;
+    const double p11 = 1./39916800.;
+    const double p12 = 1./479001600.;
+    const double p13 = 1./6227020800.;
+
+    const double min_x = -708.39;
+
+    const double ln2d_hi = 0.693145751953125;
+    const double ln2d_lo = 1.42860682030941723212E-6;
+
+    // data vectors
+    VTYPE  x, r, z, n2;
+
+    // Clamp so 2^r stays a normal number, the clamped lanes are zeroed at the end
+    x = max(initial_x, VTYPE(min_x));
+    r = round(x*VM_LOG2E);
+    // subtraction in two steps for higher precision
+    x = nmul_add(r, ln2d_hi, x);                 //  x -= r * ln2d_hi;
+    x = nmul_add(r, ln2d_lo, x);                 //  x -= r * ln2d_lo;
+
+    z = polynomial_13m(x, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13);
+
+    // multiply by power of 2
+    n2 = vm_pow2n(r);
+    z = (z + 1.0) * n2;
+
+    return select(initial_x < min_x, VTYPE(0.), z);
+}
+
+// Template parameters:
+// VTYPE:  float vector type
+// BVTYPE: boolean vector type
+template<class VTYPE, class BVTYPE>
+static inline VTYPE exp_nonpositive_f(VTYPE const & initial_x) {
+
+    EXP_NONPOSITIVE_CHECK(initial_x, 0.f)
+
+    // Taylor coefficients
+    const float P0expf   =  1.f/2.f;
+    const float P1expf   =  1.f/6.f;
+    const float P2expf   =  1.f/24.f;
+    const float P3expf   =  1.f/120.f;
+    const float P4expf   =  1.f/720.f;
+    const float P5expf   =  1.f/5040.f;
+
+    const float min_x = -87.3f;
+
+    const float ln2f_hi  =  0.693359375f;
+    const float ln2f_lo  = -2.12194440e-4f;
+
+    VTYPE  x, r, x2, z, n2;                      // data vectors
+
+    x = max(initial_x, VTYPE(min_x));
+    r = round(x*float(VM_LOG2E));
+    x = nmul_add(r, VTYPE(ln2f_hi), x);          //  x -= r * ln2f_hi;
+    x = nmul_add(r, VTYPE(ln2f_lo), x);          //  x -= r * ln2f_lo;
+
+    x2 = x * x;
+    z = polynomial_5(x,P0expf,P1expf,P2expf,P3expf,P4expf,P5expf);
+    z = mul_add(z, x2, x);                       // z *= x2;  z += x;
+
+    // multiply by power of 2
+    n2 = vm_pow2n(r);
+    z = (z + 1.0f) * n2;
+
+    return select(initial_x < min_x, VTYPE(0.f), z);
+}
+
+// instances of exp_nonpositive templates
+static inline Vec2d exp_nonpositive(Vec2d const & x) {
+    return exp_nonpositive_d<Vec2d, Vec2db>(x);
+}
+
+static inline Vec4f exp_nonpositive(Vec4f const & x) {
+    return exp_nonpositive_f<Vec4f, Vec4fb>(x);
+}
+
+#if MAX_VECTOR_SIZE >= 256
+
+static inline Vec4d exp_nonpositive(Vec4d const & x) {
+    return exp_nonpositive_d<Vec4d, Vec4db>(x);
+}
+
+static inline Vec8f exp_nonpositive(Vec8f const & x) {
+    return exp_nonpositive_f<Vec8f, Vec8fb>(x);
+}
+
+#endif // MAX_VECTOR_SIZE >= 256
+
+#if MAX_VECTOR_SIZE >= 512
+
+static inline Vec8d exp_nonpositive(Vec8d const & x) {
+    return exp_nonpositive_d<Vec8d, Vec8db>(x);
+}
+
+static inline Vec16f exp_nonpositive(Vec16f const & x) {
+    return exp_nonpositive_f<Vec16f, Vec16fb>(x);
+}
+
+#endif // MAX_VECTOR_SIZE >= 512
+
+#ifdef VCL_NAMESPACE
+}
+#endif
+
+#endif
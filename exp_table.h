@@ -0,0 +1,142 @@
+#ifndef EXP_TABLE_H
+#define EXP_TABLE_H
+
+// Include after vectorclass.h so MAX_VECTOR_SIZE is already settled
+#include "vecmath/vectorclass.h"
+
+#include <vector>
+
+/**
+ * Tabulated 1 - exp(-tau) for tau >= 0, in the style of OpenMOC's exp table.
+ *
+ * [0, tau_max) is split into equal intervals, each holding the coefficients
+ * of a linear or quadratic polynomial in tau.  Beyond tau_max the result is
+ * exactly 1; tau_max is chosen so that costs no more than the requested
+ * error.  The coefficients for one interval are stored next to each other
+ * so the gathers for one lane share a cache line.
+ *
+ * The constructor picks the cheapest interpolation whose table fits in the
+ * given number of bytes: linear if it fits, otherwise quadratic.
+ */
+class ExpTable
+{
+public:
+  /**
+   * @param max_error Maximum absolute error of the interpolated 1 - exp(-tau)
+   * @param cache_bytes Size the table has to fit in (e.g. L1 or L2 size)
+   * Throws std::invalid_argument if even the quadratic table doesn't fit
+   */
+  ExpTable(double max_error, std::size_t cache_bytes = 32 * 1024);
+
+  /// 1 or 2
+  unsigned int order() const { return _stride - 1; }
+
+  /// Number of intervals
+  unsigned int numIntervals() const { return _num_intervals; }
+
+  /// Interval width
+  double spacing() const { return _spacing; }
+
+  /// Start of the constant 1 region
+  double tauMax() const { return _tau_max; }
+
+  /// Size of the table
+  std::size_t bytes() const { return _coefficients.size() * sizeof(double); }
+
+  /// 1 - exp(-tau) for a single value
+  double compute(double tau) const;
+
+  /// 1 - exp(-tau) for tau >= 0
+  inline Vec4d compute(Vec4d const & tau) const;
+
+#if MAX_VECTOR_SIZE >= 512
+  /// 1 - exp(-tau) for tau >= 0
+  inline Vec8d compute(Vec8d const & tau) const;
+#endif
+
+protected:
+  /// Fill _coefficients for the given order / spacing
+  void build(unsigned int order, double spacing, unsigned int num_intervals);
+
+  /// Coefficients per interval: order + 1
+  unsigned int _stride;
+
+  unsigned int _num_intervals;
+
+  double _spacing;
+
+  double _inverse_spacing;
+
+  double _tau_max;
+
+  /// a, b[, c] for each interval followed by (1, 0[, 0]) for tau >= tau_max
+  std::vector<double> _coefficients;
+};
+
+/// table[index[i]] for each lane
+static inline Vec4d gatherTable(const double * table, Vec4i const & index)
+{
+#if INSTRSET >= 8
+  return _mm256_i32gather_pd(table, index, 8);
+#else
+  int i[4];
+  index.store(i);
+  return Vec4d(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+#endif
+}
+
+inline Vec4d
+ExpTable::compute(Vec4d const & tau) const
+{
+  const double * table = _coefficients.data();
+
+  Vec4d t = min(tau, Vec4d(_tau_max));
+
+  Vec4i index = truncate_to_int(t * _inverse_spacing) * (int)_stride;
+
+  Vec4d a = gatherTable(table, index);
+  Vec4d b = gatherTable(table, index + 1);
+
+  if (_stride == 2)
+    return mul_add(b, t, a);
+
+  Vec4d c = gatherTable(table, index + 2);
+
+  return mul_add(mul_add(c, t, b), t, a);
+}
+
+#if MAX_VECTOR_SIZE >= 512
+
+/// table[index[i]] for each lane
+static inline Vec8d gatherTable(const double * table, Vec8i const & index)
+{
+#if INSTRSET >= 9
+  return _mm512_i32gather_pd(index, table, 8);
+#else
+  return Vec8d(gatherTable(table, index.get_low()), gatherTable(table, index.get_high()));
+#endif
+}
+
+inline Vec8d
+ExpTable::compute(Vec8d const & tau) const
+{
+  const double * table = _coefficients.data();
+
+  Vec8d t = min(tau, Vec8d(_tau_max));
+
+  Vec8i index = truncate_to_int(t * _inverse_spacing) * (int)_stride;
+
+  Vec8d a = gatherTable(table, index);
+  Vec8d b = gatherTable(table, index + 1);
+
+  if (_stride == 2)
+    return mul_add(b, t, a);
+
+  Vec8d c = gatherTable(table, index + 2);
+
+  return mul_add(mul_add(c, t, b), t, a);
+}
+
+#endif // MAX_VECTOR_SIZE >= 512
+
+#endif
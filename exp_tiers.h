@@ -0,0 +1,127 @@
+#ifndef EXP_TIERS_H
+#define EXP_TIERS_H
+
+// Include after vectorclass.h so MAX_VECTOR_SIZE is already settled
+#include "vecmath/vectormath_exp.h"
+
+#ifdef VCL_NAMESPACE
+namespace VCL_NAMESPACE {
+#endif
+
+// Reduced accuracy variant of exp_d from vecmath/vectormath_exp.h
+//
+// DIGITS is the target accuracy: the relative error stays below 10^-DIGITS
+// everywhere exp() doesn't over/underflow.  Lower tiers drop Taylor terms
+// (truncation error after degree n is about 0.347^(n+1) / (n+1)!) and use a
+// single step range reduction:
+//
+//   DIGITS <= 5   degree 5    ~2e-6
+//   DIGITS <= 7   degree 7    ~5e-9
+//   DIGITS <= 10  degree 9    ~7e-12
+//   DIGITS <= 13  degree 11   ~6e-15
+//   otherwise     exp_d       full double precision
+//
+// Template parameters:
+// DIGITS: target number of correct decimal digits
+// VTYPE:  double vector type
+// BVTYPE: boolean vector type
+template<int DIGITS, class VTYPE, class BVTYPE>
+static inline VTYPE exp_tiered(VTYPE const & initial_x) {
+
+    if (DIGITS > 13) {
+        return exp_d<VTYPE, BVTYPE, 0, 0>(initial_x);
+    }
+
+    // Taylor coefficients, 1/n!
+    const double p2  = 1./2.;
+    const double p3  = 1./6.;
+    const double p4  = 1./24.;
+    const double p5  = 1./120.;
+    const double p6  = 1./720.;
+    const double p7  = 1./5040.;
+    const double p8  = 1./40320.;
+    const double p9  = 1./362880.;
+    const double p10 = 1./3628800.;
+    const double p11 = 1./39916800.;
+
+    const double max_x = 708.39;
+
+    // data vectors
+    VTYPE  x, r, z, n2;
+    BVTYPE inrange;                              // boolean vector
+
+    r = round(initial_x*VM_LOG2E);
+
+    if (DIGITS <= 10) {
+        x = nmul_add(r, VM_LN2, initial_x);      //  x -= r * ln2;
+    }
+    else {
+        // subtraction in two steps for higher precision
+        const double ln2d_hi = 0.693145751953125;
+        const double ln2d_lo = 1.42860682030941723212E-6;
+        x = nmul_add(r, ln2d_hi, initial_x);     //  x -= r * ln2d_hi;
+        x = nmul_add(r, ln2d_lo, x);             //  x -= r * ln2d_lo;
+    }
+
+    // z = x + x^2 * (p2 + p3*x + ...)
+    if (DIGITS <= 5) {
+        z = polynomial_3(x, p2, p3, p4, p5);
+    }
+    else if (DIGITS <= 7) {
+        z = polynomial_5(x, p2, p3, p4, p5, p6, p7);
+    }
+    else if (DIGITS <= 10) {
+        z = polynomial_7(x, p2, p3, p4, p5, p6, p7, p8, p9);
+    }
+    else {
+        z = polynomial_9(x, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11);
+    }
+    z = mul_add(z, x*x, x);
+
+    // multiply by power of 2
+    n2 = vm_pow2n(r);
+    z = (z + 1.0) * n2;
+
+    // check for overflow
+    inrange  = abs(initial_x) < max_x;
+    // check for INF and NAN
+    inrange &= is_finite(initial_x);
+
+    if (horizontal_and(inrange)) {
+        // fast normal path
+        return z;
+    }
+    else {
+        // overflow, underflow and NAN
+        r = select(sign_bit(initial_x), 0., infinite_vec<VTYPE>()); // value in case of +/- overflow or INF
+        z = select(inrange, z, r);                                  // +/- underflow
+        z = select(is_nan(initial_x), initial_x, z);                // NAN goes through
+        return z;
+    }
+}
+
+// instances of exp_tiered template
+template<int DIGITS>
+static inline Vec2d exp_digits(Vec2d const & x) {
+    return exp_tiered<DIGITS, Vec2d, Vec2db>(x);
+}
+
+#if MAX_VECTOR_SIZE >= 256
+template<int DIGITS>
+static inline Vec4d exp_digits(Vec4d const & x) {
+    return exp_tiered<DIGITS, Vec4d, Vec4db>(x);
+}
+#endif // MAX_VECTOR_SIZE >= 256
+
+#if MAX_VECTOR_SIZE >= 512
+template<int DIGITS>
+static inline Vec8d exp_digits(Vec8d const & x) {
+    return exp_tiered<DIGITS, Vec8d, Vec8db>(x);
+}
+#endif // MAX_VECTOR_SIZE >= 512
+
+#ifdef VCL_NAMESPACE
+}
+#endif
+
+#endif
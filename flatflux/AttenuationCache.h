@@ -0,0 +1,103 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef ATTENUATIONCACHE_H
+#define ATTENUATIONCACHE_H
+
+#include "FlatFluxKernel.h"
+#include "SegmentStore.h"
+
+#include <vector>
+
+/**
+ * 1 - exp(-tau) of every segment, polar angle and group of a SegmentStore,
+ * computed once so repeated sweeps with the same cross sections stream it
+ * instead of evaluating exp.
+ *
+ * Whole tracks are cached in order until the next one would go over the
+ * memory budget.  The tracks after that are evaluated on the fly.
+ * CacheScalar float halves the memory (and bandwidth) of a double cache at
+ * the cost of single precision factors.
+ */
+template <typename CacheScalar>
+class AttenuationCache
+{
+public:
+  /**
+   * @param tracks The tracks to cache (must outlive the cache)
+   * @param kernel Computes the factors: its cross sections and polar angles are the ones cached
+   * @param budget_bytes Most memory the factors may take
+   */
+  template <class Kernel>
+  AttenuationCache(const SegmentStore & tracks, Kernel & kernel, std::size_t budget_bytes);
+
+  /**
+   * Sweep track t with kernel in direction, from the cache if the track is
+   * in it.  The factors are per segment, so both directions share them.
+   */
+  template <class Kernel>
+  void onTrack(Kernel & kernel, std::size_t t, TrackDirection direction = TrackDirection::FORWARD) const
+  {
+    if (t < numCachedTracks())
+      kernel.onTrack(_tracks.track(t), &_factors[_track_offsets[t]], direction);
+    else
+      kernel.onTrack(_tracks.track(t), direction);
+  }
+
+  /// The first numCachedTracks() tracks are cached
+  std::size_t numCachedTracks() const { return _track_offsets.size() - 1; }
+
+  /// Memory taken by the factors
+  std::size_t bytes() const { return _factors.size() * sizeof(CacheScalar); }
+
+protected:
+  const SegmentStore & _tracks;
+
+  std::vector<CacheScalar> _factors;
+
+  /// Where each cached track starts in _factors, plus the end
+  std::vector<std::size_t> _track_offsets;
+};
+
+template <typename CacheScalar>
+template <class Kernel>
+AttenuationCache<CacheScalar>::AttenuationCache(const SegmentStore & tracks,
+                                                Kernel & kernel,
+                                                std::size_t budget_bytes) :
+    _tracks(tracks),
+    _track_offsets(1, 0)
+{
+  const std::size_t per_segment = kernel.angularFluxSize();
+
+  std::size_t size = 0;
+
+  std::size_t t = 0;
+  for (; t < _tracks.numTracks(); t++)
+  {
+    std::size_t track_size = _tracks.track(t).size * per_segment;
+
+    if ((size + track_size) * sizeof(CacheScalar) > budget_bytes)
+      break;
+
+    size += track_size;
+    _track_offsets.push_back(size);
+  }
+
+  _factors.resize(size);
+
+  for (std::size_t cached = 0; cached < t; cached++)
+    kernel.attenuation(_tracks.track(cached), &_factors[_track_offsets[cached]]);
+}
+
+#endif /* ATTENUATIONCACHE_H */
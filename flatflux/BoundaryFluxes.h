@@ -0,0 +1,184 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef BOUNDARYFLUXES_H
+#define BOUNDARYFLUXES_H
+
+#include "SegmentList.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * The angular flux entering every track, in each direction, at the start
+ * of a sweep, and where the flux leaving it goes.
+ *
+ * Each (track, direction) has a slot of angularFluxSize() values, laid out
+ * like FlatFluxKernel::startTrack()'s, in one arena: track major, forward
+ * then backward, each slot starting on a cache line.  Tracks swept in order
+ * read their incoming fluxes from consecutive memory.
+ *
+ * The flux leaving a (track, direction) at a reflective or periodic
+ * boundary enters another (track, direction): link() records that once,
+ * ahead of the sweeps, as an offset into the arena.  Ends that aren't
+ * linked are vacuum: what leaves them is dropped, and the flux entering an
+ * end nothing is linked to is 0 from the second sweep on, whatever the
+ * first sweep started it from.
+ *
+ * The outgoing fluxes are written to a second arena so a sweep never reads
+ * a flux written during the same sweep: the result doesn't depend on the
+ * order tracks are swept in, and threads need no locks as long as each slot
+ * is linked from at most one end (link() enforces it).  swap() after a
+ * sweep makes the outgoing fluxes the next sweep's incoming ones, and
+ * zeroes the slots nothing writes.
+ */
+template <typename Scalar>
+class BoundaryFluxes
+{
+public:
+  /// Bytes each slot is aligned and padded to
+  static constexpr std::size_t SLOT_ALIGNMENT = 64;
+
+  BoundaryFluxes(std::size_t num_tracks, unsigned int angular_flux_size) :
+      _num_tracks(num_tracks),
+      _angular_flux_size(angular_flux_size),
+      _slot_stride((angular_flux_size * sizeof(Scalar) + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT /
+                   sizeof(Scalar)),
+      _links(2 * num_tracks, VACUUM),
+      _linked(2 * num_tracks, false),
+      _arena(nullptr)
+  {
+    void * memory = nullptr;
+
+    if (posix_memalign(&memory, SLOT_ALIGNMENT, std::max(bytes(), SLOT_ALIGNMENT)))
+      throw std::bad_alloc();
+
+    _arena = static_cast<Scalar *>(memory);
+
+    std::memset(_arena, 0, bytes());
+  }
+
+  ~BoundaryFluxes() { std::free(_arena); }
+
+  BoundaryFluxes(const BoundaryFluxes &) = delete;
+  BoundaryFluxes & operator=(const BoundaryFluxes &) = delete;
+
+  /**
+   * The flux leaving track in direction enters to_track in to_direction on
+   * the next sweep
+   */
+  void link(std::size_t track, TrackDirection direction, std::size_t to_track, TrackDirection to_direction)
+  {
+    if (track >= _num_tracks || to_track >= _num_tracks)
+      throw std::out_of_range("BoundaryFluxes: no such track");
+
+    const std::size_t to = slot(to_track, to_direction);
+
+    if (_linked[to])
+      throw std::invalid_argument("BoundaryFluxes: a track end can only be fed by one other");
+
+    // Unlink whatever this end fed before
+    const std::size_t from = slot(track, direction);
+
+    if (_links[from] != VACUUM)
+      _linked[_links[from] / _slot_stride] = false;
+
+    _links[from] = to * _slot_stride;
+    _linked[to] = true;
+  }
+
+  /**
+   * The flux entering track in direction this sweep: writing it sets the
+   * flux for this sweep only, linked or not
+   */
+  Scalar * incoming(std::size_t track, TrackDirection direction)
+  {
+    return _arena + _current * arenaSize() + slot(track, direction) * _slot_stride;
+  }
+
+  const Scalar * incoming(std::size_t track, TrackDirection direction) const
+  {
+    return _arena + _current * arenaSize() + slot(track, direction) * _slot_stride;
+  }
+
+  /// Where the flux leaving track in direction goes for the next sweep: nullptr at a vacuum boundary
+  Scalar * outgoing(std::size_t track, TrackDirection direction)
+  {
+    const std::size_t link = _links[slot(track, direction)];
+
+    return link == VACUUM ? nullptr : _arena + (1 - _current) * arenaSize() + link;
+  }
+
+  /// Make the fluxes written to outgoing() the incoming() ones, and those of unlinked ends 0
+  void swap()
+  {
+    _current = 1 - _current;
+
+    // Whatever was written into an unlinked slot of this arena two sweeps ago would come back otherwise
+    for (std::size_t s = 0; s < _linked.size(); s++)
+      if (!_linked[s])
+        std::fill_n(_arena + _current * arenaSize() + s * _slot_stride, _angular_flux_size, Scalar(0));
+  }
+
+  std::size_t numTracks() const { return _num_tracks; }
+
+  unsigned int angularFluxSize() const { return _angular_flux_size; }
+
+  /// Values from the start of one slot to the start of the next
+  std::size_t slotStride() const { return _slot_stride; }
+
+  /// Memory taken by both arenas, padding included
+  std::size_t bytes() const { return 2 * arenaSize() * sizeof(Scalar); }
+
+protected:
+  /// _links value of an end that isn't linked anywhere
+  static constexpr std::size_t VACUUM = static_cast<std::size_t>(-1);
+
+  std::size_t slot(std::size_t track, TrackDirection direction) const
+  {
+    return 2 * track + static_cast<std::size_t>(direction);
+  }
+
+  /// Values in one arena
+  std::size_t arenaSize() const { return 2 * _num_tracks * _slot_stride; }
+
+  const std::size_t _num_tracks;
+
+  const unsigned int _angular_flux_size;
+
+  const std::size_t _slot_stride;
+
+  /// Offset into an arena of the slot each (track, direction) feeds, or VACUUM
+  std::vector<std::size_t> _links;
+
+  /// Whether some end feeds each slot
+  std::vector<bool> _linked;
+
+  /// Which of the two arenas holds the incoming fluxes
+  unsigned int _current = 0;
+
+  Scalar * _arena;
+};
+
+template <typename Scalar>
+constexpr std::size_t BoundaryFluxes<Scalar>::SLOT_ALIGNMENT;
+
+template <typename Scalar>
+constexpr std::size_t BoundaryFluxes<Scalar>::VACUUM;
+
+#endif /* BOUNDARYFLUXES_H */
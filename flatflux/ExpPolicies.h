@@ -0,0 +1,156 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef EXPPOLICIES_H
+#define EXPPOLICIES_H
+
+#include "FlatFluxKernel.h"
+
+#include "../vecmath/vectormath_exp.h"
+#include "../exp_attenuation.h"
+
+#include "fmath.h"
+
+#ifdef __INTEL_MKL__
+#include "mkl.h"
+#endif
+
+#include <cmath>
+
+/**
+ * Exp backends for FlatFluxKernel.  Each one computes 1 - exp(-tau) for
+ * tau >= 0, either for an array (used with SimdWidth == 1):
+ *
+ *   static void oneMinusExpNeg(const Scalar * tau, Scalar * out, unsigned int n);
+ *
+ * or for one vector class register (used with SimdWidth > 1):
+ *
+ *   template <class Vector> static Vector oneMinusExpNeg(Vector const & tau);
+ *
+ * out may be the same array as tau.
+ */
+
+/// std::exp, one value at a time
+struct StdExpPolicy
+{
+  template <typename Scalar>
+  static inline void oneMinusExpNeg(const Scalar * tau, Scalar * out, unsigned int n)
+  {
+#pragma clang loop vectorize_width(4) interleave_count(4)
+    for (unsigned int g = 0; g < n; g++)
+      out[g] = 1 - std::exp(-tau[g]);
+  }
+};
+
+/// fmath's scalar exp
+struct FMathExpPolicy
+{
+  static inline void oneMinusExpNeg(const double * tau, double * out, unsigned int n)
+  {
+    for (unsigned int g = 0; g < n; g++)
+      out[g] = 1. - fmath::expd(-tau[g]);
+  }
+
+  static inline void oneMinusExpNeg(const float * tau, float * out, unsigned int n)
+  {
+    for (unsigned int g = 0; g < n; g++)
+      out[g] = 1.f - fmath::exp(-tau[g]);
+  }
+};
+
+#ifdef __INTEL_MKL__
+/// MKL's vector math library on the whole array
+struct MKLExpPolicy
+{
+  static inline void oneMinusExpNeg(const double * tau, double * out, unsigned int n)
+  {
+    for (unsigned int g = 0; g < n; g++)
+      out[g] = -tau[g];
+
+    vdExp(n, out, out);
+
+    for (unsigned int g = 0; g < n; g++)
+      out[g] = 1. - out[g];
+  }
+
+  static inline void oneMinusExpNeg(const float * tau, float * out, unsigned int n)
+  {
+    for (unsigned int g = 0; g < n; g++)
+      out[g] = -tau[g];
+
+    vsExp(n, out, out);
+
+    for (unsigned int g = 0; g < n; g++)
+      out[g] = 1.f - out[g];
+  }
+};
+#endif
+
+/// The fused one_minus_exp_neg() from exp_attenuation.h
+struct VectorClassExpPolicy
+{
+  template <class Vector>
+  static inline Vector oneMinusExpNeg(Vector const & tau)
+  {
+    return one_minus_exp_neg(tau);
+  }
+
+  static inline void oneMinusExpNeg(const double * tau, double * out, unsigned int n)
+  {
+    oneMinusExpNegArray<Vec4d, 4>(tau, out, n);
+  }
+
+  static inline void oneMinusExpNeg(const float * tau, float * out, unsigned int n)
+  {
+    oneMinusExpNegArray<Vec8f, 8>(tau, out, n);
+  }
+
+protected:
+  template <class Vector, unsigned int Width, typename Scalar>
+  static inline void oneMinusExpNegArray(const Scalar * tau, Scalar * out, unsigned int n)
+  {
+    unsigned int num_chunks = n / Width;
+
+    unsigned int remainder = n % Width;
+
+    Vector x;
+
+    for (unsigned int chunk = 0; chunk < num_chunks; chunk++)
+    {
+      x.load(tau + chunk * Width);
+      one_minus_exp_neg(x).store(out + chunk * Width);
+    }
+
+    // The remainder
+    if (remainder)
+    {
+      x.load_partial(remainder, tau + num_chunks * Width);
+      one_minus_exp_neg(x).store_partial(remainder, out + num_chunks * Width);
+    }
+  }
+};
+
+#if defined(__INTEL_COMPILER)
+/// Intel's SVML exp through the vector class
+struct SVMLExpPolicy
+{
+  template <class Vector>
+  static inline Vector oneMinusExpNeg(Vector const & tau)
+  {
+    return 1 - expSVML(-tau);
+  }
+};
+#endif
+
+#endif /* EXPPOLICIES_H */
@@ -0,0 +1,824 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef FLATFLUXKERNEL_H
+#define FLATFLUXKERNEL_H
+
+#include "flat_flux_common.h"
+#include "LocalArray.h"
+#include "MaterialTable.h"
+#include "SegmentList.h"
+#include "SimdVector.h"
+#include "TallyPolicies.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Flat source MOC update of the angular and scalar flux along one segment.
+ *
+ * Scalar: float or double storage and arithmetic
+ * ExpPolicy: where 1 - exp(-tau) comes from (see ExpPolicies.h)
+ * SimdWidth: 1 works a polar angle at a time through arrays, computing all of
+ *            its 1 - exp(-tau) with ExpPolicy's array function.  Anything
+ *            else keeps SimdWidth groups at a time in SimdVector registers
+ *            and uses ExpPolicy's vector function.
+ * TallyPolicy: how the scalar flux and FSR volumes are added into (see
+ *              TallyPolicies.h).  PlainTally unless several kernels share
+ *              the arrays at once.
+ * NumGroups: energy groups.  Needn't be a multiple of SimdWidth: the last
+ *            chunk of each row is loaded and stored with masks.
+ * NumPolar: polar angles.
+ * TallyScalar: what the scalar flux and FSR volumes are summed in.  double
+ *              with float Scalar stores and streams everything else
+ *              (angular flux, Q, sigma_t, cached attenuation) in float, but
+ *              doesn't lose the small contributions of a long sweep to
+ *              float rounding.
+ *
+ * NumGroups and NumPolar are compile-time sizes, so the loops over them
+ * unroll and the angular flux a track carries fits in a fixed set of
+ * registers.  RUNTIME_SIZE for either takes the count from the constructor
+ * instead: one build then handles any cross section library, with the
+ * carried angular flux spilled to an array (see KernelSizes.h for picking
+ * between the two).
+ *
+ * scalar_flux and Q hold numGroups() values per FSR, fsr_solution one.
+ *
+ * onSegment() / onTrack() are not virtual: they inline into the caller.
+ */
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy = PlainTally,
+          unsigned int NumGroups = NUM_GROUPS,
+          unsigned int NumPolar = NUM_POLAR,
+          typename TallyScalar = Scalar>
+class FlatFluxKernel
+{
+public:
+  /**
+   * @param num_materials Number of rows in the sigma_t table
+   * @param num_groups Energy groups: must be NumGroups unless that is RUNTIME_SIZE
+   * @param num_polar Polar angles: must be NumPolar unless that is RUNTIME_SIZE
+   */
+  FlatFluxKernel(std::vector<TallyScalar> & scalar_flux,
+                 std::vector<TallyScalar> & fsr_solution,
+                 std::vector<Scalar> & Q,
+                 unsigned int num_materials = 1,
+                 unsigned int num_groups = NumGroups,
+                 unsigned int num_polar = NumPolar);
+
+  /// Compile-time constants unless the kernel is RUNTIME_SIZE
+  unsigned int numGroups() const { return NumGroups == RUNTIME_SIZE ? _num_groups : NumGroups; }
+  unsigned int numPolar() const { return NumPolar == RUNTIME_SIZE ? _num_polar : NumPolar; }
+
+  /// Values in the angular flux: numPolar() * numGroups()
+  unsigned int angularFluxSize() const { return numPolar() * numGroups(); }
+
+  /**
+   * Total cross section of every material, indexed by the segments'
+   * material ids.  Starts out as made up values: fill it in for real ones.
+   */
+  MaterialTable<Scalar> & sigmaT() { return _sigma_t; }
+
+  /**
+   * Called on each Segment: a 1.1 long segment through FSR 0 with material 0
+   */
+  inline void onSegment();
+
+  /**
+   * A single segment of the given (in plane) length through fsr, whose
+   * material is material
+   */
+  inline void onSegment(unsigned int fsr, Scalar length, unsigned int material);
+
+  /// onTrack() sweeps one direction (see BidirectionalFlatFluxKernel for one that sweeps both)
+  static constexpr bool sweeps_both_directions = false;
+
+  /**
+   * Sweep all of a track's segments in direction: from the first to the
+   * last FORWARD, from the last to the first BACKWARD.  With SimdWidth > 1
+   * the angular flux stays in registers for the whole track.  The Q, scalar
+   * flux and sigma_t rows of the next segment are prefetched while the
+   * current one is computed.
+   */
+  inline void onTrack(const SegmentList & segments, TrackDirection direction = TrackDirection::FORWARD);
+
+  /**
+   * Start a new track: the angular flux becomes angular_flux
+   * (angularFluxSize() values, polar angle major) and the dead zone starts
+   * over
+   */
+  inline void startTrack(const Scalar * angular_flux);
+
+  /// The current angular flux, laid out like startTrack()'s
+  const Scalar * angularFlux() const { return _angular_flux.data(); }
+
+  /**
+   * 1 - exp(-tau) for every segment of a track, polar angle and group, in
+   * the order onTrack() uses them: angularFluxSize() values per segment,
+   * polar angle major.  CacheScalar may be narrower than Scalar.
+   */
+  template <typename CacheScalar>
+  inline void attenuation(const SegmentList & segments, CacheScalar * factors);
+
+  /**
+   * onTrack() reading 1 - exp(-tau) from factors filled by attenuation()
+   * (on a kernel with the same cross sections) instead of evaluating it.
+   * The factors are per segment, so one cache serves both directions.
+   */
+  template <typename CacheScalar>
+  inline void onTrack(const SegmentList & segments,
+                      const CacheScalar * factors,
+                      TrackDirection direction = TrackDirection::FORWARD);
+
+protected:
+  /// Selects the array or the register implementation of updateGroups() / track()
+  template <bool>
+  struct ArrayUpdate
+  {
+  };
+
+  /// Full SIMD chunks in a row of groups, and the lanes in the masked chunk after them
+  unsigned int fullChunks() const { return numGroups() / SimdWidth; }
+  unsigned int tailLanes() const { return numGroups() % SimdWidth; }
+  unsigned int numChunks() const { return fullChunks() + (tailLanes() ? 1 : 0); }
+
+  /// Registers the SIMD track() carries the angular flux in: RUNTIME_SIZE if that isn't known until run time
+  static constexpr unsigned int num_registers =
+      NumGroups == RUNTIME_SIZE || NumPolar == RUNTIME_SIZE ? RUNTIME_SIZE
+                                                            : NumPolar * ((NumGroups + SimdWidth - 1) / SimdWidth);
+
+  /// track() evaluating 1 - exp(-tau) with ExpPolicy
+  struct EvaluatedAttenuation
+  {
+    template <class Vector>
+    inline Vector
+    factor(const Scalar * sigma_t, Scalar segment_length, std::size_t /* index */, unsigned int lanes) const
+    {
+      Vector loaded;
+      loadLanes(loaded, sigma_t, lanes);
+      return ExpPolicy::oneMinusExpNeg(loaded * segment_length);
+    }
+  };
+
+  /// track() reading 1 - exp(-tau) from an attenuation() cache: index counts from the start of the track
+  template <typename CacheScalar>
+  struct CachedAttenuation
+  {
+    template <class Vector>
+    inline Vector
+    factor(const Scalar * /* sigma_t */, Scalar /* segment_length */, std::size_t index, unsigned int lanes) const
+    {
+      Vector loaded;
+      loadFactors(loaded, factors + index, lanes);
+      return loaded;
+    }
+
+    const CacheScalar * factors;
+  };
+
+  /// The segment swept i-th in direction
+  static std::size_t segmentIndex(const SegmentList & segments, std::size_t i, TrackDirection direction)
+  {
+    return direction == TrackDirection::FORWARD ? i : segments.size - 1 - i;
+  }
+
+  /// Bring the rows the segment after this one needs into cache: next past either end is ignored
+  inline void prefetchSegment(const SegmentList & segments, std::size_t next);
+
+  /// Bring numGroups() values starting at row into L1
+  template <typename T>
+  inline void prefetchRow(const T * row) const;
+
+  inline void track(const SegmentList & segments, TrackDirection direction, EvaluatedAttenuation, ArrayUpdate<true>);
+
+  template <typename CacheScalar>
+  inline void track(const SegmentList & segments,
+                    TrackDirection direction,
+                    CachedAttenuation<CacheScalar> cached,
+                    ArrayUpdate<true>);
+
+  template <class Attenuation>
+  inline void track(const SegmentList & segments,
+                    TrackDirection direction,
+                    const Attenuation & attenuation,
+                    ArrayUpdate<false>);
+
+  /// 1 - exp(-sigma_t * segment_length) for every group into factors
+  inline void attenuationRow(const Scalar * sigma_t, Scalar segment_length, Scalar * factors, ArrayUpdate<true>);
+
+  inline void attenuationRow(const Scalar * sigma_t, Scalar segment_length, Scalar * factors, ArrayUpdate<false>);
+
+  /**
+   * The array update of one polar angle once _exp_tau holds its 1 - exp(-tau):
+   * attenuate the angular flux and tally the change
+   */
+  inline void applyAttenuation(Scalar * angular_flux,
+                               TallyScalar * scalar_flux,
+                               const Scalar * Q,
+                               Scalar scalar_flux_multiplier);
+
+  /**
+   * Attenuate the angular flux of one polar angle over segment_length and
+   * add scalar_flux_multiplier times the change into the scalar flux
+   */
+  inline void updateGroups(Scalar * angular_flux,
+                           TallyScalar * scalar_flux,
+                           const Scalar * Q,
+                           const Scalar * sigma_t,
+                           Scalar segment_length,
+                           Scalar scalar_flux_multiplier,
+                           ArrayUpdate<true>);
+
+  inline void updateGroups(Scalar * angular_flux,
+                           TallyScalar * scalar_flux,
+                           const Scalar * Q,
+                           const Scalar * sigma_t,
+                           Scalar segment_length,
+                           Scalar scalar_flux_multiplier,
+                           ArrayUpdate<false>);
+
+  /// Contribution of a segment of length to its FSR's volume for one polar angle
+  inline Scalar volumeContribution(Scalar length, unsigned int p) const
+  {
+    return _azimuthal_spacing * _azimuthal_weight * length * 0.5 * _polar_spacing * _polar_weights[p];
+  }
+
+  /// Factor from the change in angular flux to the scalar flux for one polar angle
+  inline Scalar scalarFluxMultiplier(unsigned int p) const
+  {
+    return 4.0 * PI * _azimuthal_spacing * _polar_spacing * _azimuthal_weight * _polar_weights[p] *
+           _polar_sins[p];
+  }
+
+  /// Distance to travel before accumulating into scalar flux
+  const Scalar _dead_zone;
+
+  const unsigned int _num_groups;
+
+  const unsigned int _num_polar;
+
+  TallyScalar * _scalar_flux;
+
+  TallyScalar * _fsr_volumes;
+
+  Scalar * _Q;
+
+  /// The Azimuthal spacing for the Ray
+  Scalar _azimuthal_spacing = 0.01;
+
+  /// The Azimuthal weight for the Ray
+  Scalar _azimuthal_weight = 0.02;
+
+  /// Pointer to the beginning of the Ray's data
+  std::vector<Scalar> _angular_flux;
+
+  /// Polar spacing
+  Scalar _polar_spacing = 0.02;
+
+  /// Sin of the polar angle
+  std::vector<Scalar> _polar_sins;
+
+  /// Weights for the polar angles
+  std::vector<Scalar> _polar_weights;
+
+  /// Distance travelled so far, compared against _dead_zone
+  Scalar _integrated_distance = 0;
+
+  std::vector<Scalar> _delta_angular_flux;
+
+  std::vector<Scalar> _exp_tau;
+
+  /// numGroups() values per material
+  MaterialTable<Scalar> _sigma_t;
+};
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::FlatFluxKernel(std::vector<TallyScalar> & scalar_flux,
+                                                                                                            std::vector<TallyScalar> & fsr_solution,
+                                                                                                            std::vector<Scalar> & Q,
+                                                                                                            unsigned int num_materials,
+                                                                                                            unsigned int num_groups,
+                                                                                                            unsigned int num_polar) :
+    _dead_zone(0),
+    _num_groups(num_groups),
+    _num_polar(num_polar),
+    _scalar_flux(scalar_flux.data()),
+    _fsr_volumes(fsr_solution.data()),
+    _Q(Q.data()),
+    _angular_flux(num_polar * num_groups),
+    _polar_sins(num_polar),
+    _polar_weights(num_polar),
+    _delta_angular_flux(_num_groups),
+    _exp_tau(_num_groups),
+    _sigma_t(num_materials, _num_groups)
+{
+  if ((NumGroups != RUNTIME_SIZE && num_groups != NumGroups) || (NumPolar != RUNTIME_SIZE && num_polar != NumPolar))
+    throw std::invalid_argument("FlatFluxKernel: num_groups / num_polar don't match the compiled sizes");
+
+  if (num_groups == 0 || num_polar == 0)
+    throw std::invalid_argument("FlatFluxKernel: needs at least one group and polar angle");
+
+  for (unsigned int m = 0; m < num_materials; m++)
+    for (unsigned int i = 0; i < _num_groups; i++)
+      _sigma_t.row(m)[i] = (double)(i + m)/(double)1000;
+
+  for (unsigned int i = 0; i < _angular_flux.size(); i++)
+    _angular_flux[i] = (double)i/(double)230;
+
+  // Equal weight polar angles
+  for (unsigned int p = 0; p < _num_polar; p++)
+  {
+    _polar_sins[p] = (p + 0.5) / _num_polar;
+    _polar_weights[p] = 1. / _num_polar;
+  }
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::onSegment()
+{
+  onSegment(0, 1.1, 0);
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::onTrack(const SegmentList & segments,
+                                                                                                     TrackDirection direction)
+{
+  track(segments, direction, EvaluatedAttenuation(), ArrayUpdate<SimdWidth == 1>());
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+template <typename CacheScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::onTrack(const SegmentList & segments,
+                                                                                                     const CacheScalar * factors,
+                                                                                                     TrackDirection direction)
+{
+  CachedAttenuation<CacheScalar> cached;
+  cached.factors = factors;
+
+  track(segments, direction, cached, ArrayUpdate<SimdWidth == 1>());
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+template <typename CacheScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::attenuation(const SegmentList & segments,
+                                                                                                         CacheScalar * factors)
+{
+  for (std::size_t s = 0; s < segments.size; s++)
+  {
+    const Scalar * current_sigma_t = _sigma_t.row(segments.material_ids[s]);
+
+    for (unsigned int p = 0; p < numPolar(); p++)
+    {
+      const Scalar segment_length = segments.lengths[s] / _polar_sins[p];
+
+      attenuationRow(current_sigma_t, segment_length, _exp_tau.data(), ArrayUpdate<SimdWidth == 1>());
+
+      std::copy(_exp_tau.begin(), _exp_tau.end(), factors + (s * numPolar() + p) * numGroups());
+    }
+  }
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::startTrack(const Scalar * angular_flux)
+{
+  std::copy(angular_flux, angular_flux + angularFluxSize(), _angular_flux.begin());
+
+  _integrated_distance = 0;
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::onSegment(unsigned int fsr, Scalar length, unsigned int material)
+{
+  const bool past_dead_zone = _integrated_distance >= _dead_zone;
+
+  for (unsigned int p = 0; p < numPolar(); p++)
+  {
+    const Scalar segment_length = length / _polar_sins[p];
+
+    // Inside the dead zone the angular flux still attenuates but nothing is tallied
+    const Scalar scalar_flux_multiplier = past_dead_zone ? scalarFluxMultiplier(p) : 0;
+
+    updateGroups(&_angular_flux[p * numGroups()],
+                 &_scalar_flux[fsr * numGroups()],
+                 &_Q[fsr * numGroups()],
+                 _sigma_t.row(material),
+                 segment_length,
+                 scalar_flux_multiplier,
+                 ArrayUpdate<SimdWidth == 1>());
+
+    if (past_dead_zone)
+      TallyPolicy::add(&_fsr_volumes[fsr], volumeContribution(length, p));
+  }
+
+  _integrated_distance += length;
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+template <typename T>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::prefetchRow(const T * row) const
+{
+  const char * begin = (const char *)row;
+  const char * end = begin + numGroups() * sizeof(T);
+
+  // Every line the row touches: Q and scalar flux rows needn't start on one
+  for (const char * line = begin - (std::uintptr_t)begin % 64; line < end; line += 64)
+    _mm_prefetch(line, _MM_HINT_T0);
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::prefetchSegment(const SegmentList & segments, std::size_t next)
+{
+  if (next >= segments.size)
+    return;
+
+  prefetchRow(&_Q[segments.fsr_ids[next] * numGroups()]);
+  prefetchRow(&_scalar_flux[segments.fsr_ids[next] * numGroups()]);
+  prefetchRow(_sigma_t.row(segments.material_ids[next]));
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::track(const SegmentList & segments,
+                                                                                                   TrackDirection direction,
+                                                                                                   EvaluatedAttenuation,
+                                                                                                   ArrayUpdate<true>)
+{
+  for (std::size_t i = 0; i < segments.size; i++)
+  {
+    const std::size_t s = segmentIndex(segments, i, direction);
+
+    prefetchSegment(segments, segmentIndex(segments, i + 1, direction));
+
+    onSegment(segments.fsr_ids[s], segments.lengths[s], segments.material_ids[s]);
+  }
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+template <typename CacheScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::track(const SegmentList & segments,
+                                                                                                   TrackDirection direction,
+                                                                                                   CachedAttenuation<CacheScalar> cached,
+                                                                                                   ArrayUpdate<true>)
+{
+  for (std::size_t i = 0; i < segments.size; i++)
+  {
+    const std::size_t s = segmentIndex(segments, i, direction);
+
+    prefetchSegment(segments, segmentIndex(segments, i + 1, direction));
+
+    const unsigned int fsr = segments.fsr_ids[s];
+
+    const bool past_dead_zone = _integrated_distance >= _dead_zone;
+
+    for (unsigned int p = 0; p < numPolar(); p++)
+    {
+      const CacheScalar * factors = cached.factors + (s * numPolar() + p) * numGroups();
+
+      std::copy(factors, factors + numGroups(), _exp_tau.begin());
+
+      applyAttenuation(&_angular_flux[p * numGroups()],
+                       &_scalar_flux[fsr * numGroups()],
+                       &_Q[fsr * numGroups()],
+                       past_dead_zone ? scalarFluxMultiplier(p) : 0);
+
+      if (past_dead_zone)
+        TallyPolicy::add(&_fsr_volumes[fsr], volumeContribution(segments.lengths[s], p));
+    }
+
+    _integrated_distance += segments.lengths[s];
+  }
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+template <class Attenuation>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::track(const SegmentList & segments,
+                                                                                                   TrackDirection direction,
+                                                                                                   const Attenuation & attenuation,
+                                                                                                   ArrayUpdate<false>)
+{
+  typedef typename SimdVector<Scalar, SimdWidth>::type Vector;
+
+  const unsigned int num_polar = numPolar();
+  const unsigned int num_groups = numGroups();
+  const unsigned int full_chunks = fullChunks();
+  const unsigned int tail_lanes = tailLanes();
+  const unsigned int num_chunks = numChunks();
+
+  // Carried across all the segments instead of going through _angular_flux each time
+  LocalArray<Vector, num_registers> angular_flux(num_polar * num_chunks);
+
+  for (unsigned int p = 0; p < num_polar; p++)
+    for (unsigned int chunk = 0; chunk < num_chunks; chunk++)
+      loadLanes(angular_flux[p * num_chunks + chunk],
+                &_angular_flux[p * num_groups + chunk * SimdWidth],
+                chunk < full_chunks ? SimdWidth : tail_lanes);
+
+  LocalArray<Scalar, NumPolar> multipliers(num_polar);
+  for (unsigned int p = 0; p < num_polar; p++)
+    multipliers[p] = scalarFluxMultiplier(p);
+
+  Vector Q, delta_angular_flux;
+
+  for (std::size_t i = 0; i < segments.size; i++)
+  {
+    const std::size_t s = segmentIndex(segments, i, direction);
+
+    prefetchSegment(segments, segmentIndex(segments, i + 1, direction));
+
+    const unsigned int fsr = segments.fsr_ids[s];
+
+    const Scalar length = segments.lengths[s];
+
+    const Scalar * current_sigma_t = _sigma_t.row(segments.material_ids[s]);
+
+    const Scalar * current_Q = &_Q[fsr * num_groups];
+
+    TallyScalar * current_scalar_flux = &_scalar_flux[fsr * num_groups];
+
+    const bool past_dead_zone = _integrated_distance >= _dead_zone;
+
+    for (unsigned int p = 0; p < num_polar; p++)
+    {
+      const Scalar segment_length = length / _polar_sins[p];
+
+      const Scalar scalar_flux_multiplier = past_dead_zone ? multipliers[p] : 0;
+
+      auto update_chunk = [&](unsigned int chunk, unsigned int lanes)
+      {
+        const unsigned int g = chunk * SimdWidth;
+
+        Vector & current_angular_flux = angular_flux[p * num_chunks + chunk];
+
+        loadLanes(Q, current_Q + g, lanes);
+
+        const std::size_t index = (s * num_polar + p) * num_groups + g;
+
+        delta_angular_flux = (current_angular_flux - Q) *
+                             attenuation.template factor<Vector>(current_sigma_t + g, segment_length, index, lanes);
+
+        current_angular_flux -= delta_angular_flux;
+
+        TallyPolicy::addScaled(current_scalar_flux + g, scalar_flux_multiplier, delta_angular_flux, lanes);
+      };
+
+      for (unsigned int chunk = 0; chunk < full_chunks; chunk++)
+        update_chunk(chunk, SimdWidth);
+
+      if (tail_lanes)
+        update_chunk(full_chunks, tail_lanes);
+
+      if (past_dead_zone)
+        TallyPolicy::add(&_fsr_volumes[fsr], volumeContribution(length, p));
+    }
+
+    _integrated_distance += length;
+  }
+
+  for (unsigned int p = 0; p < num_polar; p++)
+    for (unsigned int chunk = 0; chunk < num_chunks; chunk++)
+      storeLanes(angular_flux[p * num_chunks + chunk],
+                 &_angular_flux[p * num_groups + chunk * SimdWidth],
+                 chunk < full_chunks ? SimdWidth : tail_lanes);
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::updateGroups(Scalar * current_angular_flux,
+                                                                                                          TallyScalar * current_scalar_flux,
+                                                                                                          const Scalar * current_Q,
+                                                                                                          const Scalar * current_sigma_t,
+                                                                                                          Scalar segment_length,
+                                                                                                          Scalar scalar_flux_multiplier,
+                                                                                                          ArrayUpdate<true>)
+{
+  attenuationRow(current_sigma_t, segment_length, _exp_tau.data(), ArrayUpdate<true>());
+
+  applyAttenuation(current_angular_flux, current_scalar_flux, current_Q, scalar_flux_multiplier);
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::attenuationRow(const Scalar * current_sigma_t,
+                                                                                                            Scalar segment_length,
+                                                                                                            Scalar * factors,
+                                                                                                            ArrayUpdate<true>)
+{
+#pragma clang loop vectorize_width(4) interleave_count(4)
+  for (unsigned int g = 0; g < numGroups(); g++)
+    factors[g] = segment_length * current_sigma_t[g];
+
+  ExpPolicy::oneMinusExpNeg(factors, factors, numGroups());
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::attenuationRow(const Scalar * current_sigma_t,
+                                                                                                            Scalar segment_length,
+                                                                                                            Scalar * factors,
+                                                                                                            ArrayUpdate<false>)
+{
+  typedef typename SimdVector<Scalar, SimdWidth>::type Vector;
+
+  const unsigned int full_chunks = fullChunks();
+  const unsigned int tail_lanes = tailLanes();
+  const unsigned int num_chunks = numChunks();
+
+  for (unsigned int chunk = 0; chunk < num_chunks; chunk++)
+  {
+    const unsigned int g = chunk * SimdWidth;
+    const unsigned int lanes = chunk < full_chunks ? SimdWidth : tail_lanes;
+
+    storeLanes(EvaluatedAttenuation().template factor<Vector>(current_sigma_t + g, segment_length, g, lanes),
+               factors + g,
+               lanes);
+  }
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::applyAttenuation(Scalar * current_angular_flux,
+                                                                                                              TallyScalar * current_scalar_flux,
+                                                                                                              const Scalar * current_Q,
+                                                                                                              Scalar scalar_flux_multiplier)
+{
+  auto current_delta_angular_flux = &_delta_angular_flux[0];
+
+#pragma clang loop vectorize_width(4) interleave_count(4)
+  for (unsigned int g = 0; g < numGroups(); g++)
+    current_delta_angular_flux[g] = (current_angular_flux[g] - current_Q[g]) * _exp_tau[g];
+
+#pragma clang loop vectorize_width(4) interleave_count(4)
+  for (unsigned int g = 0; g < numGroups(); g++)
+    current_angular_flux[g] -= current_delta_angular_flux[g];
+
+#pragma clang loop vectorize_width(4) interleave_count(4)
+  for (unsigned int g = 0; g < numGroups(); g++)
+    TallyPolicy::add(&current_scalar_flux[g], scalar_flux_multiplier * current_delta_angular_flux[g]);
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::updateGroups(Scalar * current_angular_flux,
+                                                                                                          TallyScalar * current_scalar_flux,
+                                                                                                          const Scalar * current_Q,
+                                                                                                          const Scalar * current_sigma_t,
+                                                                                                          Scalar segment_length,
+                                                                                                          Scalar scalar_flux_multiplier,
+                                                                                                          ArrayUpdate<false>)
+{
+  typedef typename SimdVector<Scalar, SimdWidth>::type Vector;
+
+  const unsigned int full_chunks = fullChunks();
+  const unsigned int tail_lanes = tailLanes();
+  const unsigned int num_chunks = numChunks();
+
+  Vector sigma_t, Q, angular_flux, delta_angular_flux;
+
+  for (unsigned int chunk = 0; chunk < num_chunks; chunk++)
+  {
+    const unsigned int g = chunk * SimdWidth;
+    const unsigned int lanes = chunk < full_chunks ? SimdWidth : tail_lanes;
+
+    loadLanes(sigma_t, &current_sigma_t[g], lanes);
+    loadLanes(Q, &current_Q[g], lanes);
+    loadLanes(angular_flux, &current_angular_flux[g], lanes);
+
+    delta_angular_flux = (angular_flux - Q) * ExpPolicy::oneMinusExpNeg(sigma_t * segment_length);
+
+    angular_flux -= delta_angular_flux;
+
+    TallyPolicy::addScaled(&current_scalar_flux[g], scalar_flux_multiplier, delta_angular_flux, lanes);
+
+    storeLanes(angular_flux, &current_angular_flux[g], lanes);
+  }
+}
+
+#endif /* FLATFLUXKERNEL_H */
@@ -0,0 +1,186 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef FLATTENEDFLATFLUXKERNEL_H
+#define FLATTENEDFLATFLUXKERNEL_H
+
+#include "FlatFluxKernel.h"
+
+/**
+ * FlatFluxKernel whose onTrack() treats the numPolar() * numGroups() angular
+ * flux as one flat array of registers and runs the polar angles innermost:
+ * each SimdWidth groups of Q are loaded once per segment, the scalar flux
+ * contributions of all the polar angles are summed in a register and added
+ * to the scalar flux with a single load / store, and the FSR volume gets
+ * one add per segment instead of one per polar angle.
+ *
+ * onSegment() is the base class's.  Only the register (SimdWidth > 1) path
+ * exists.
+ */
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy = PlainTally,
+          unsigned int NumGroups = NUM_GROUPS,
+          unsigned int NumPolar = NUM_POLAR,
+          typename TallyScalar = Scalar>
+class FlattenedFlatFluxKernel : public FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>
+{
+public:
+  typedef FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar> Base;
+
+  FlattenedFlatFluxKernel(std::vector<TallyScalar> & scalar_flux,
+                          std::vector<TallyScalar> & fsr_solution,
+                          std::vector<Scalar> & Q,
+                          unsigned int num_materials = 1,
+                          unsigned int num_groups = NumGroups,
+                          unsigned int num_polar = NumPolar) :
+      Base(scalar_flux, fsr_solution, Q, num_materials, num_groups, num_polar)
+  {
+    static_assert(SimdWidth > 1, "FlattenedFlatFluxKernel needs SIMD registers");
+  }
+
+  /// Base::onTrack() with the polar angles innermost, in either direction
+  inline void onTrack(const SegmentList & segments, TrackDirection direction = TrackDirection::FORWARD)
+  {
+    flattenedTrack(segments, direction, typename Base::EvaluatedAttenuation());
+  }
+
+  template <typename CacheScalar>
+  inline void onTrack(const SegmentList & segments,
+                      const CacheScalar * factors,
+                      TrackDirection direction = TrackDirection::FORWARD)
+  {
+    typename Base::template CachedAttenuation<CacheScalar> cached;
+    cached.factors = factors;
+
+    flattenedTrack(segments, direction, cached);
+  }
+
+protected:
+  template <class Attenuation>
+  inline void
+  flattenedTrack(const SegmentList & segments, TrackDirection direction, const Attenuation & attenuation);
+};
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+template <class Attenuation>
+void
+FlattenedFlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::flattenedTrack(
+    const SegmentList & segments, TrackDirection direction, const Attenuation & attenuation)
+{
+  typedef typename SimdVector<Scalar, SimdWidth>::type Vector;
+
+  const unsigned int num_polar = this->numPolar();
+  const unsigned int num_groups = this->numGroups();
+  const unsigned int full_chunks = this->fullChunks();
+  const unsigned int tail_lanes = this->tailLanes();
+  const unsigned int num_chunks = this->numChunks();
+
+  LocalArray<Vector, Base::num_registers> angular_flux(num_polar * num_chunks);
+
+  for (unsigned int p = 0; p < num_polar; p++)
+    for (unsigned int chunk = 0; chunk < num_chunks; chunk++)
+      loadLanes(angular_flux[p * num_chunks + chunk],
+                &this->_angular_flux[p * num_groups + chunk * SimdWidth],
+                chunk < full_chunks ? SimdWidth : tail_lanes);
+
+  LocalArray<Scalar, NumPolar> multipliers(num_polar);
+  LocalArray<Scalar, NumPolar> inverse_sins(num_polar);
+  LocalArray<Scalar, NumPolar> segment_lengths(num_polar);
+  Scalar volume_per_length = 0;
+
+  for (unsigned int p = 0; p < num_polar; p++)
+  {
+    multipliers[p] = this->scalarFluxMultiplier(p);
+    inverse_sins[p] = 1. / this->_polar_sins[p];
+    volume_per_length += this->volumeContribution(1, p);
+  }
+
+  Vector Q, delta_angular_flux, scalar_flux_change;
+
+  for (std::size_t i = 0; i < segments.size; i++)
+  {
+    const std::size_t s = Base::segmentIndex(segments, i, direction);
+
+    this->prefetchSegment(segments, Base::segmentIndex(segments, i + 1, direction));
+
+    const unsigned int fsr = segments.fsr_ids[s];
+
+    const Scalar length = segments.lengths[s];
+
+    const Scalar * current_sigma_t = this->_sigma_t.row(segments.material_ids[s]);
+
+    const Scalar * current_Q = &this->_Q[fsr * num_groups];
+
+    TallyScalar * current_scalar_flux = &this->_scalar_flux[fsr * num_groups];
+
+    const bool past_dead_zone = this->_integrated_distance >= this->_dead_zone;
+
+    for (unsigned int p = 0; p < num_polar; p++)
+      segment_lengths[p] = length * inverse_sins[p];
+
+    auto update_chunk = [&](unsigned int chunk, unsigned int lanes)
+    {
+      const unsigned int g = chunk * SimdWidth;
+
+      loadLanes(Q, current_Q + g, lanes);
+
+      scalar_flux_change = 0;
+
+      for (unsigned int p = 0; p < num_polar; p++)
+      {
+        Vector & current_angular_flux = angular_flux[p * num_chunks + chunk];
+
+        const std::size_t index = (s * num_polar + p) * num_groups + g;
+
+        delta_angular_flux =
+            (current_angular_flux - Q) *
+            attenuation.template factor<Vector>(current_sigma_t + g, segment_lengths[p], index, lanes);
+
+        current_angular_flux -= delta_angular_flux;
+
+        scalar_flux_change = mul_add(multipliers[p], delta_angular_flux, scalar_flux_change);
+      }
+
+      // Inside the dead zone the angular flux still attenuates but nothing is tallied
+      TallyPolicy::addScaled(current_scalar_flux + g, Scalar(past_dead_zone ? 1 : 0), scalar_flux_change, lanes);
+    };
+
+    for (unsigned int chunk = 0; chunk < full_chunks; chunk++)
+      update_chunk(chunk, SimdWidth);
+
+    if (tail_lanes)
+      update_chunk(full_chunks, tail_lanes);
+
+    if (past_dead_zone)
+      TallyPolicy::add(&this->_fsr_volumes[fsr], length * volume_per_length);
+
+    this->_integrated_distance += length;
+  }
+
+  for (unsigned int p = 0; p < num_polar; p++)
+    for (unsigned int chunk = 0; chunk < num_chunks; chunk++)
+      storeLanes(angular_flux[p * num_chunks + chunk],
+                 &this->_angular_flux[p * num_groups + chunk * SimdWidth],
+                 chunk < full_chunks ? SimdWidth : tail_lanes);
+}
+
+#endif /* FLATTENEDFLATFLUXKERNEL_H */
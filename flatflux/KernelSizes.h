@@ -0,0 +1,74 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef KERNELSIZES_H
+#define KERNELSIZES_H
+
+#include "flat_flux_common.h"
+
+/**
+ * The (groups, polar angles) pairs that get kernels with compile-time sizes,
+ * as X(groups, polar) for each: the common cross section libraries and
+ * quadratures.  Every other pair runs on RUNTIME_SIZE kernels.
+ *
+ * Each pair costs one more instantiation of whatever dispatchKernelSizes()
+ * is called with, so keep the list short.
+ */
+#define SPECIALIZED_KERNEL_SIZES(X) \
+  X(7, 3)                           \
+  X(8, 2)                           \
+  X(32, 3)                          \
+  X(70, 3)
+
+/**
+ * Calls action.template run<NumGroups, NumPolar>() with the specialized
+ * sizes matching num_groups and num_polar if there are some, and with
+ * RUNTIME_SIZE for both otherwise.  Kernels action builds still get
+ * num_groups and num_polar passed to their constructors.
+ *
+ * Action looks like:
+ *
+ *   struct Action
+ *   {
+ *     template <unsigned int NumGroups, unsigned int NumPolar>
+ *     void run();
+ *   };
+ */
+template <class Action>
+void
+dispatchKernelSizes(unsigned int num_groups, unsigned int num_polar, Action & action)
+{
+#define DISPATCH_KERNEL_SIZE(GROUPS, POLAR)        \
+  if (num_groups == GROUPS && num_polar == POLAR) \
+    return action.template run<GROUPS, POLAR>();
+
+  SPECIALIZED_KERNEL_SIZES(DISPATCH_KERNEL_SIZE)
+
+#undef DISPATCH_KERNEL_SIZE
+
+  action.template run<RUNTIME_SIZE, RUNTIME_SIZE>();
+}
+
+/// Whether dispatchKernelSizes() has compile-time sizes for num_groups and num_polar
+inline bool
+specializedKernelSize(unsigned int num_groups, unsigned int num_polar)
+{
+#define MATCH_KERNEL_SIZE(GROUPS, POLAR) (num_groups == GROUPS && num_polar == POLAR) ||
+
+  return SPECIALIZED_KERNEL_SIZES(MATCH_KERNEL_SIZE) false;
+
+#undef MATCH_KERNEL_SIZE
+}
+
+#endif /* KERNELSIZES_H */
@@ -0,0 +1,346 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef LINEARSOURCEKERNEL_H
+#define LINEARSOURCEKERNEL_H
+
+#include "FlatFluxKernel.h"
+
+/**
+ * Below this optical length linearSourceFunctions() uses its Taylor
+ * polynomials instead of the closed forms, which lose more digits to
+ * cancellation the smaller tau gets.  Neither is good to full precision at
+ * the cutoff: it sits where the polynomials' truncation error meets the
+ * closed forms' cancellation, and moving it either way makes the worst
+ * case worse.  That worst case (linear_source/track's counters) is about
+ * 8e-7 relative for float f2 and 3.4e-6 for float h, just above the
+ * cutoff, and 2e-14 and 6e-13 for double.
+ */
+template <typename Scalar>
+struct LinearSourceSeries;
+
+template <>
+struct LinearSourceSeries<double>
+{
+  static constexpr double cutoff = 0.5;
+};
+
+template <>
+struct LinearSourceSeries<float>
+{
+  static constexpr float cutoff = 2;
+};
+
+constexpr double LinearSourceSeries<double>::cutoff;
+constexpr float LinearSourceSeries<float>::cutoff;
+
+/**
+ * The exponential functions of the linear source update, divided by the
+ * powers of tau that keep them finite in a void:
+ *
+ *   F1(tau) = 1 - exp(-tau)                            (given)
+ *   f2(tau) = (2 tau - (2 + tau) F1(tau)) / tau^2      ~ tau / 6
+ *   h(tau) = (1/12 - f2(tau) / 4 - f2(tau) / 2 tau) / tau  ~ tau / 120
+ *
+ * Both closed forms cancel catastrophically as tau goes to 0, so below
+ * LinearSourceSeries<Scalar>::cutoff they come from their Taylor
+ * polynomials (12 terms each).  The closed forms are only evaluated when
+ * some lane needs them.
+ */
+template <typename Scalar, class Vector>
+inline void
+linearSourceFunctions(Vector const & tau, Vector const & f1, Vector & f2, Vector & h)
+{
+  // f2 = sum over k >= 1 of (-1)^(k+1) k / (k+2)! tau^k
+  static const double f2_coefficients[] = {1. / 6,
+                                           -1. / 12,
+                                           1. / 40,
+                                           -1. / 180,
+                                           1. / 1008,
+                                           -1. / 6720,
+                                           1. / 51840,
+                                           -1. / 453600,
+                                           1. / 4435200,
+                                           -1. / 47900160,
+                                           1. / 566092800,
+                                           -1. / 7264857600};
+
+  // h = sum over k >= 3 of (-1)^(k+1) (k-2) (k+1) / 4 (k+2)! tau^(k-2)
+  static const double h_coefficients[] = {1. / 120,
+                                          -1. / 288,
+                                          1. / 1120,
+                                          -1. / 5760,
+                                          1. / 36288,
+                                          -1. / 268800,
+                                          1. / 2280960,
+                                          -1. / 21772800,
+                                          1. / 230630400,
+                                          -1. / 2682408960,
+                                          1. / 33965568000,
+                                          -1. / 464950886400};
+
+  const unsigned int terms = sizeof(f2_coefficients) / sizeof(double);
+
+  Vector f2_series = Scalar(f2_coefficients[terms - 1]);
+  Vector h_series = Scalar(h_coefficients[terms - 1]);
+
+  for (int k = terms - 2; k >= 0; k--)
+  {
+    f2_series = mul_add(f2_series, tau, Scalar(f2_coefficients[k]));
+    h_series = mul_add(h_series, tau, Scalar(h_coefficients[k]));
+  }
+
+  f2 = f2_series * tau;
+  h = h_series * tau;
+
+  auto closed = tau >= LinearSourceSeries<Scalar>::cutoff;
+
+  if (horizontal_or(closed))
+  {
+    const Vector inverse_tau = Scalar(1) / tau;
+
+    const Vector f2_closed = (Scalar(2) * tau - (tau + Scalar(2)) * f1) * inverse_tau * inverse_tau;
+    const Vector h_closed =
+        (Scalar(1. / 12) - Scalar(0.25) * f2_closed - Scalar(0.5) * f2_closed * inverse_tau) * inverse_tau;
+
+    f2 = select(closed, f2_closed, f2);
+    h = select(closed, h_closed, h);
+  }
+}
+
+/// Where a track starts and which way it goes in the plane
+struct TrackGeometry
+{
+  double x;
+  double y;
+
+  /// Cosine and sine of the azimuthal angle
+  double cos_azimuthal;
+  double sin_azimuthal;
+};
+
+/**
+ * Linear source MOC: each FSR's source is Q + Q_x (x - x_c) + Q_y (y - y_c)
+ * about its centroid (x_c, y_c), and alongside the scalar flux the kernel
+ * tallies its x and y moments.  Everything is reduced (divided by sigma_t)
+ * like FlatFluxKernel's Q, so nothing is divided by sigma_t on a segment
+ * and voids are fine.
+ *
+ * For a segment of in-plane length l through an FSR, starting at distance s
+ * along the track, with tau = sigma_t * l / sin(polar):
+ *
+ *   (dx, dy) = segment midpoint - centroid
+ *   Q_mid = Q + Q_x dx + Q_y dy      source at the midpoint
+ *   Q_slope = Q_x ux + Q_y uy        source gradient along the track
+ *   delta psi = (psi - Q_mid) F1 - tau l Q_slope f2 / 2
+ *   sigma_t * moment along the track =
+ *       tau l / sin(polar) * (-(psi - Q_mid) f2 / 2 + tau l Q_slope h)
+ *
+ * The scalar flux tally is FlatFluxKernel's.  The x moment tally gets
+ * dx (delta psi + tau Q_mid) + ux sin(polar) (sigma_t * moment) with the
+ * same weight, and y likewise.
+ *
+ * scalar_flux_moments and source_moments hold 2 * numGroups() values per
+ * FSR: the x row, then the y row.  centroids holds x, y per FSR.
+ *
+ * The polar angles are innermost, like FlattenedFlatFluxKernel.  Only the
+ * register (SimdWidth > 1) path exists.
+ */
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy = PlainTally,
+          unsigned int NumGroups = NUM_GROUPS,
+          unsigned int NumPolar = NUM_POLAR,
+          typename TallyScalar = Scalar>
+class LinearSourceKernel : public FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>
+{
+public:
+  typedef FlatFluxKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar> Base;
+
+  LinearSourceKernel(std::vector<TallyScalar> & scalar_flux,
+                     std::vector<TallyScalar> & scalar_flux_moments,
+                     std::vector<TallyScalar> & fsr_solution,
+                     std::vector<Scalar> & Q,
+                     std::vector<Scalar> & source_moments,
+                     const std::vector<double> & centroids,
+                     unsigned int num_materials = 1,
+                     unsigned int num_groups = NumGroups,
+                     unsigned int num_polar = NumPolar) :
+      Base(scalar_flux, fsr_solution, Q, num_materials, num_groups, num_polar),
+      _scalar_flux_moments(scalar_flux_moments.data()),
+      _source_moments(source_moments.data()),
+      _centroids(centroids.data())
+  {
+    static_assert(SimdWidth > 1, "LinearSourceKernel needs SIMD registers");
+  }
+
+  /// Sweep all of a track's segments in order: geometry places them in the plane
+  inline void onTrack(const SegmentList & segments, const TrackGeometry & geometry);
+
+protected:
+  TallyScalar * _scalar_flux_moments;
+
+  Scalar * _source_moments;
+
+  const double * _centroids;
+};
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          typename TallyPolicy,
+          unsigned int NumGroups,
+          unsigned int NumPolar,
+          typename TallyScalar>
+void
+LinearSourceKernel<Scalar, ExpPolicy, SimdWidth, TallyPolicy, NumGroups, NumPolar, TallyScalar>::onTrack(
+    const SegmentList & segments, const TrackGeometry & geometry)
+{
+  typedef typename SimdVector<Scalar, SimdWidth>::type Vector;
+
+  const unsigned int num_polar = this->numPolar();
+  const unsigned int num_groups = this->numGroups();
+  const unsigned int full_chunks = this->fullChunks();
+  const unsigned int tail_lanes = this->tailLanes();
+  const unsigned int num_chunks = this->numChunks();
+
+  LocalArray<Vector, Base::num_registers> angular_flux(num_polar * num_chunks);
+
+  for (unsigned int p = 0; p < num_polar; p++)
+    for (unsigned int chunk = 0; chunk < num_chunks; chunk++)
+      loadLanes(angular_flux[p * num_chunks + chunk],
+                &this->_angular_flux[p * num_groups + chunk * SimdWidth],
+                chunk < full_chunks ? SimdWidth : tail_lanes);
+
+  LocalArray<Scalar, NumPolar> multipliers(num_polar);
+  LocalArray<Scalar, NumPolar> inverse_sins(num_polar);
+  LocalArray<Scalar, NumPolar> segment_lengths(num_polar);
+  Scalar volume_per_length = 0;
+
+  for (unsigned int p = 0; p < num_polar; p++)
+  {
+    multipliers[p] = this->scalarFluxMultiplier(p);
+    inverse_sins[p] = 1. / this->_polar_sins[p];
+    volume_per_length += this->volumeContribution(1, p);
+  }
+
+  const Scalar ux = geometry.cos_azimuthal;
+  const Scalar uy = geometry.sin_azimuthal;
+
+  // Distance along the track to the start of the current segment
+  double distance = 0;
+
+  Vector Q, Q_x, Q_y, Q_mid, Q_slope, sigma_t, tau, f1, f2, h;
+  Vector reduced_flux, delta_angular_flux, moment;
+  Vector scalar_flux_change, x_moment_change, y_moment_change;
+
+  for (std::size_t s = 0; s < segments.size; s++)
+  {
+    this->prefetchSegment(segments, s + 1);
+
+    const unsigned int fsr = segments.fsr_ids[s];
+
+    const Scalar length = segments.lengths[s];
+
+    const Scalar dx = geometry.x + (distance + 0.5 * length) * geometry.cos_azimuthal - _centroids[2 * fsr];
+    const Scalar dy = geometry.y + (distance + 0.5 * length) * geometry.sin_azimuthal - _centroids[2 * fsr + 1];
+
+    const Scalar * current_sigma_t = this->_sigma_t.row(segments.material_ids[s]);
+
+    const Scalar * current_Q = &this->_Q[fsr * num_groups];
+    const Scalar * current_Q_x = &_source_moments[2 * fsr * num_groups];
+    const Scalar * current_Q_y = current_Q_x + num_groups;
+
+    TallyScalar * current_scalar_flux = &this->_scalar_flux[fsr * num_groups];
+    TallyScalar * current_x_moment = &_scalar_flux_moments[2 * fsr * num_groups];
+    TallyScalar * current_y_moment = current_x_moment + num_groups;
+
+    const bool past_dead_zone = this->_integrated_distance >= this->_dead_zone;
+
+    for (unsigned int p = 0; p < num_polar; p++)
+      segment_lengths[p] = length * inverse_sins[p];
+
+    auto update_chunk = [&](unsigned int chunk, unsigned int lanes)
+    {
+      const unsigned int g = chunk * SimdWidth;
+
+      loadLanes(Q, current_Q + g, lanes);
+      loadLanes(Q_x, current_Q_x + g, lanes);
+      loadLanes(Q_y, current_Q_y + g, lanes);
+      loadLanes(sigma_t, current_sigma_t + g, lanes);
+
+      Q_mid = mul_add(Q_y, dy, mul_add(Q_x, dx, Q));
+      Q_slope = Q_x * ux + Q_y * uy;
+
+      scalar_flux_change = 0;
+      x_moment_change = 0;
+      y_moment_change = 0;
+
+      for (unsigned int p = 0; p < num_polar; p++)
+      {
+        Vector & current_angular_flux = angular_flux[p * num_chunks + chunk];
+
+        tau = sigma_t * segment_lengths[p];
+        f1 = ExpPolicy::oneMinusExpNeg(tau);
+        linearSourceFunctions<Scalar>(tau, f1, f2, h);
+
+        reduced_flux = current_angular_flux - Q_mid;
+
+        const Vector tau_slope = tau * length * Q_slope;
+
+        delta_angular_flux = reduced_flux * f1 - Scalar(0.5) * tau_slope * f2;
+
+        moment = tau * segment_lengths[p] * (tau_slope * h - Scalar(0.5) * reduced_flux * f2);
+
+        current_angular_flux -= delta_angular_flux;
+
+        // Moment about the segment midpoint along the track, projected on x and y
+        const Vector total = mul_add(tau, Q_mid, delta_angular_flux);
+        const Scalar along = multipliers[p] * this->_polar_sins[p];
+
+        scalar_flux_change = mul_add(multipliers[p], delta_angular_flux, scalar_flux_change);
+        x_moment_change = mul_add(multipliers[p] * dx, total, mul_add(along * ux, moment, x_moment_change));
+        y_moment_change = mul_add(multipliers[p] * dy, total, mul_add(along * uy, moment, y_moment_change));
+      }
+
+      // Inside the dead zone the angular flux still attenuates but nothing is tallied
+      const Scalar tally = past_dead_zone ? 1 : 0;
+
+      TallyPolicy::addScaled(current_scalar_flux + g, tally, scalar_flux_change, lanes);
+      TallyPolicy::addScaled(current_x_moment + g, tally, x_moment_change, lanes);
+      TallyPolicy::addScaled(current_y_moment + g, tally, y_moment_change, lanes);
+    };
+
+    for (unsigned int chunk = 0; chunk < full_chunks; chunk++)
+      update_chunk(chunk, SimdWidth);
+
+    if (tail_lanes)
+      update_chunk(full_chunks, tail_lanes);
+
+    if (past_dead_zone)
+      TallyPolicy::add(&this->_fsr_volumes[fsr], length * volume_per_length);
+
+    this->_integrated_distance += length;
+    distance += length;
+  }
+
+  for (unsigned int p = 0; p < num_polar; p++)
+    for (unsigned int chunk = 0; chunk < num_chunks; chunk++)
+      storeLanes(angular_flux[p * num_chunks + chunk],
+                 &this->_angular_flux[p * num_groups + chunk * SimdWidth],
+                 chunk < full_chunks ? SimdWidth : tail_lanes);
+}
+
+#endif /* LINEARSOURCEKERNEL_H */
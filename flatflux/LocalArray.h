@@ -0,0 +1,74 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef LOCALARRAY_H
+#define LOCALARRAY_H
+
+#include "flat_flux_common.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+/**
+ * A kernel function's local array of T.  With a compile-time Size it's a
+ * plain array the compiler can keep in registers.  With Size RUNTIME_SIZE
+ * it holds the size given to the constructor on the heap, aligned for
+ * vector class types.
+ */
+template <typename T, unsigned int Size>
+class LocalArray
+{
+public:
+  explicit LocalArray(unsigned int /* size */) {}
+
+  T & operator[](unsigned int i) { return _values[i]; }
+
+  const T & operator[](unsigned int i) const { return _values[i]; }
+
+protected:
+  T _values[Size];
+};
+
+template <typename T>
+class LocalArray<T, RUNTIME_SIZE>
+{
+public:
+  explicit LocalArray(unsigned int size)
+  {
+    void * memory = nullptr;
+
+    if (posix_memalign(&memory, std::max(alignof(T), sizeof(void *)), std::max(size, 1u) * sizeof(T)))
+      throw std::bad_alloc();
+
+    _values = static_cast<T *>(memory);
+
+    for (unsigned int i = 0; i < size; i++)
+      new (_values + i) T;
+  }
+
+  ~LocalArray() { std::free(_values); }
+
+  LocalArray(const LocalArray &) = delete;
+  LocalArray & operator=(const LocalArray &) = delete;
+
+  T & operator[](unsigned int i) { return _values[i]; }
+
+  const T & operator[](unsigned int i) const { return _values[i]; }
+
+protected:
+  T * _values;
+};
+
+#endif /* LOCALARRAY_H */
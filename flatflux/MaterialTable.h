@@ -0,0 +1,86 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef MATERIALTABLE_H
+#define MATERIALTABLE_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/**
+ * One cross section of every material by (material, group): a single array
+ * with a row of groups per material.  Each row starts on a cache line and
+ * is padded to a whole number of them (the padding is zero), so a segment's
+ * row is never split across more lines than it has to be, and prefetching
+ * it fetches nothing else.
+ */
+template <typename Scalar>
+class MaterialTable
+{
+public:
+  /// Bytes each row is aligned and padded to
+  static constexpr std::size_t ROW_ALIGNMENT = 64;
+
+  MaterialTable(unsigned int num_materials, unsigned int num_groups) :
+      _num_materials(num_materials),
+      _num_groups(num_groups),
+      _row_stride((num_groups * sizeof(Scalar) + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT / sizeof(Scalar)),
+      _values(nullptr)
+  {
+    void * memory = nullptr;
+
+    if (posix_memalign(&memory, ROW_ALIGNMENT, std::max(bytes(), ROW_ALIGNMENT)))
+      throw std::bad_alloc();
+
+    _values = static_cast<Scalar *>(memory);
+
+    std::memset(_values, 0, bytes());
+  }
+
+  ~MaterialTable() { std::free(_values); }
+
+  MaterialTable(const MaterialTable &) = delete;
+  MaterialTable & operator=(const MaterialTable &) = delete;
+
+  /// The numGroups() values of a material
+  Scalar * row(unsigned int material) { return _values + material * _row_stride; }
+
+  const Scalar * row(unsigned int material) const { return _values + material * _row_stride; }
+
+  unsigned int numMaterials() const { return _num_materials; }
+
+  unsigned int numGroups() const { return _num_groups; }
+
+  /// Values from the start of one row to the start of the next
+  std::size_t rowStride() const { return _row_stride; }
+
+  /// Memory taken by the table, padding included
+  std::size_t bytes() const { return _num_materials * _row_stride * sizeof(Scalar); }
+
+protected:
+  const unsigned int _num_materials;
+
+  const unsigned int _num_groups;
+
+  const std::size_t _row_stride;
+
+  Scalar * _values;
+};
+
+template <typename Scalar>
+constexpr std::size_t MaterialTable<Scalar>::ROW_ALIGNMENT;
+
+#endif /* MATERIALTABLE_H */
@@ -0,0 +1,46 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef SEGMENTLIST_H
+#define SEGMENTLIST_H
+
+#include <cstddef>
+
+/// Which way along a track it is swept
+enum class TrackDirection
+{
+  FORWARD = 0,
+  BACKWARD = 1
+};
+
+/**
+ * The segments of one track, in order along the track, as parallel arrays.
+ * Doesn't own the arrays.
+ */
+struct SegmentList
+{
+  /// Flat source region each segment crosses
+  const unsigned int * fsr_ids;
+
+  /// Length of each segment in the plane (before dividing by the polar sine)
+  const double * lengths;
+
+  /// Material of each segment's FSR
+  const unsigned int * material_ids;
+
+  /// Number of segments
+  std::size_t size;
+};
+
+#endif /* SEGMENTLIST_H */
@@ -0,0 +1,132 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef SEGMENTSTORE_H
+#define SEGMENTSTORE_H
+
+#include "SegmentList.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * The segments of every track as structure of arrays: all the lengths, then
+ * all the FSR ids, then all the material ids, with each track's segments
+ * contiguous and a table of where each track starts.
+ *
+ * A store is either built in memory with addTrack() and written out with
+ * write(), or memory-mapped read-only from such a file.  Mapping is zero
+ * copy: startup costs no parsing, pages are read on first touch, and every
+ * process on a node mapping the same file shares one copy in the page cache.
+ *
+ * File layout (native byte order, each array 64 byte aligned):
+ *
+ *   Header
+ *   uint64_t track_offsets[num_tracks + 1]
+ *   double   lengths[num_segments]
+ *   uint32_t fsr_ids[num_segments]
+ *   uint32_t material_ids[num_segments]
+ *
+ * Mapping checks the header, the array layout and the track offsets, so
+ * track() never reads outside the file, but it doesn't read the id arrays:
+ * that would touch every page up front.  The kernels index the flux, source
+ * and material tables with the ids unchecked, so a file from anywhere but
+ * this build's own write() should go through checkIds() before it's swept.
+ */
+class SegmentStore
+{
+public:
+  /// Empty in-memory store
+  SegmentStore();
+
+  /**
+   * Map a file written by write().
+   * Throws std::runtime_error if it can't be opened / mapped, isn't a segment file or
+   * its sizes or track offsets don't fit the file
+   */
+  explicit SegmentStore(const std::string & filename);
+
+  ~SegmentStore();
+
+  SegmentStore(const SegmentStore &) = delete;
+  SegmentStore & operator=(const SegmentStore &) = delete;
+
+  /**
+   * Append a track to an in-memory store.  All three arrays have one entry per segment.
+   * Throws std::logic_error on a mapped store.
+   */
+  void addTrack(const std::vector<unsigned int> & fsr_ids,
+                const std::vector<double> & lengths,
+                const std::vector<unsigned int> & material_ids);
+
+  /**
+   * Check every FSR id is below num_fsrs and every material id below num_materials.
+   * Reads all of both id arrays.  Throws std::runtime_error naming the first bad segment.
+   */
+  void checkIds(std::size_t num_fsrs, std::size_t num_materials) const;
+
+  /// Write the store to filename.  Throws std::runtime_error on failure.
+  void write(const std::string & filename) const;
+
+  std::size_t numTracks() const { return _num_tracks; }
+
+  std::size_t numSegments() const { return _num_segments; }
+
+  /// Whether the arrays live in a mapped file
+  bool mapped() const { return _mapping != nullptr; }
+
+  /// The segments of track t
+  SegmentList track(std::size_t t) const
+  {
+    std::size_t begin = _track_offsets[t];
+
+    SegmentList segments;
+    segments.fsr_ids = _fsr_ids + begin;
+    segments.lengths = _lengths + begin;
+    segments.material_ids = _material_ids + begin;
+    segments.size = _track_offsets[t + 1] - begin;
+
+    return segments;
+  }
+
+protected:
+  /// Point the array pointers at the owned vectors
+  void pointAtVectors();
+
+  std::size_t _num_tracks;
+
+  std::size_t _num_segments;
+
+  const std::uint64_t * _track_offsets;
+
+  const double * _lengths;
+
+  const unsigned int * _fsr_ids;
+
+  const unsigned int * _material_ids;
+
+  /// The in-memory arrays (empty when mapped)
+  std::vector<std::uint64_t> _owned_track_offsets;
+  std::vector<double> _owned_lengths;
+  std::vector<unsigned int> _owned_fsr_ids;
+  std::vector<unsigned int> _owned_material_ids;
+
+  /// Start and size of the mapped file
+  void * _mapping;
+
+  std::size_t _mapping_size;
+};
+
+#endif /* SEGMENTSTORE_H */
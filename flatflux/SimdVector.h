@@ -0,0 +1,112 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef SIMDVECTOR_H
+#define SIMDVECTOR_H
+
+#ifndef MAX_VECTOR_SIZE
+#define MAX_VECTOR_SIZE 512
+#endif
+
+#include "../vecmath/vectorclass.h"
+
+/**
+ * The vector class type holding Width values of Scalar
+ */
+template <typename Scalar, unsigned int Width>
+struct SimdVector;
+
+template <>
+struct SimdVector<double, 4>
+{
+  typedef Vec4d type;
+};
+
+template <>
+struct SimdVector<float, 8>
+{
+  typedef Vec8f type;
+};
+
+#if MAX_VECTOR_SIZE >= 512
+template <>
+struct SimdVector<double, 8>
+{
+  typedef Vec8d type;
+};
+
+template <>
+struct SimdVector<float, 16>
+{
+  typedef Vec16f type;
+};
+#endif
+
+/**
+ * Load the first lanes values of a vector, zeroing the rest: the masked
+ * final chunk of a row whose length isn't a multiple of the vector size
+ */
+template <class Vector, typename T>
+inline void
+loadLanes(Vector & vector, const T * values, unsigned int lanes)
+{
+  if (lanes == sizeof(Vector) / sizeof(T))
+    vector.load(values);
+  else
+    vector.load_partial(lanes, values);
+}
+
+/// Store the first lanes values of a vector
+template <class Vector, typename T>
+inline void
+storeLanes(const Vector & vector, T * values, unsigned int lanes)
+{
+  if (lanes == sizeof(Vector) / sizeof(T))
+    vector.store(values);
+  else
+    vector.store_partial(lanes, values);
+}
+
+/**
+ * Load lanes cached 1 - exp(-tau) factors (see
+ * FlatFluxKernel::attenuation()), widening float caches for double kernels
+ */
+template <class Vector, typename CacheScalar>
+inline void
+loadFactors(Vector & factors, const CacheScalar * cache, unsigned int lanes)
+{
+  loadLanes(factors, cache, lanes);
+}
+
+inline void
+loadFactors(Vec4d & factors, const float * cache, unsigned int lanes)
+{
+  Vec4f narrow;
+  lanes == 4 ? narrow.load(cache) : narrow.load_partial(lanes, cache);
+
+  factors = extend_low(Vec8f(narrow, Vec4f(0.f)));
+}
+
+#if MAX_VECTOR_SIZE >= 512
+inline void
+loadFactors(Vec8d & factors, const float * cache, unsigned int lanes)
+{
+  Vec8f narrow;
+  lanes == 8 ? narrow.load(cache) : narrow.load_partial(lanes, cache);
+
+  factors = Vec8d(extend_low(narrow), extend_high(narrow));
+}
+#endif
+
+#endif /* SIMDVECTOR_H */
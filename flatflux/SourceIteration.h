@@ -0,0 +1,338 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef SOURCEITERATION_H
+#define SOURCEITERATION_H
+
+#include "ThreadedSweep.h"
+
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Multigroup cross sections of one material, one value per group each.
+ * sigma_s is the scattering matrix by (from group, to group): from major.
+ */
+template <typename Scalar>
+struct MultigroupMaterial
+{
+  std::vector<Scalar> sigma_t;
+  std::vector<Scalar> nu_sigma_f;
+  std::vector<Scalar> chi;
+  std::vector<Scalar> sigma_s;
+};
+
+/// Seconds spent in each phase of SourceIteration::iterate(), summed over the iterations
+struct SourceIterationTimings
+{
+  /// Building Q from the scalar flux
+  double source = 0;
+
+  /// Sweeping every track, the ThreadedSweep's own tally reduction included
+  double sweep = 0;
+
+  /// Turning the tallies into the scalar flux, and the new k and residual
+  double reduction = 0;
+};
+
+/**
+ * k-eigenvalue power iteration around a ThreadedSweep: each iteration
+ * builds the reduced source
+ *
+ *   Q = (sum over g' of sigma_s[g' -> g] phi[g'] + chi[g] / k * sum over g' of nu_sigma_f[g'] phi[g'])
+ *       / (4 pi sigma_t[g])
+ *
+ * of every FSR, sweeps every track with it in both directions, and turns
+ * the tallies into the
+ * new scalar flux with
+ *
+ *   phi = tally / (sigma_t * volume) + 4 pi Q
+ *
+ * using the FSR volumes the sweep tallied.  k is scaled by the ratio of the
+ * new and old total fission production, and the residual is the RMS over
+ * the fissile FSRs of the relative change in their fission production.
+ *
+ * fsr_materials gives each FSR's material.  The tracks' segments must use
+ * the material of the FSR they cross.  Every material needs sigma_t > 0 in
+ * every group: the reduced source has no meaning in a void.
+ *
+ * NumGroups and NumPolar are the sweep kernels' compile-time sizes as in
+ * ThreadedSweep; the constructor's num_groups and num_polar are the actual
+ * ones.
+ */
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          unsigned int NumGroups = NUM_GROUPS,
+          unsigned int NumPolar = NUM_POLAR>
+class SourceIteration
+{
+public:
+  /**
+   * boundary_fluxes, if given, links the tracks' ends (see
+   * ThreadedSweep::setBoundaryFluxes()); otherwise every track starts from
+   * the sweep's fixed angular flux.  tracks and boundary_fluxes must
+   * outlive the iteration.  Every material needs num_groups values of each
+   * cross section, num_groups * num_groups of sigma_s.
+   */
+  SourceIteration(const SegmentStore & tracks,
+                  const std::vector<unsigned int> & fsr_materials,
+                  const std::vector<MultigroupMaterial<Scalar>> & materials,
+                  unsigned int num_threads,
+                  SweepReduction reduction,
+                  BoundaryFluxes<Scalar> * boundary_fluxes = nullptr,
+                  unsigned int num_groups = NumGroups,
+                  unsigned int num_polar = NumPolar);
+
+  /// One power iteration: source update, sweep, reduction
+  void iterate();
+
+  /**
+   * Iterate until the residual is below tolerance, at most max_iterations
+   * times.  Returns whether it converged.
+   */
+  bool solve(Scalar tolerance, unsigned int max_iterations);
+
+  Scalar k() const { return _k; }
+
+  /// Residual of the last iteration
+  Scalar residual() const { return _residual; }
+
+  unsigned int numIterations() const { return _num_iterations; }
+
+  const SourceIterationTimings & timings() const { return _timings; }
+
+  unsigned int numGroups() const { return _num_groups; }
+
+  /// numGroups() values per FSR
+  const std::vector<Scalar> & scalarFlux() const { return _scalar_flux; }
+
+protected:
+  typedef std::chrono::steady_clock Clock;
+
+  static double seconds(Clock::time_point start) { return std::chrono::duration<double>(Clock::now() - start).count(); }
+
+  /// Q of every FSR from _scalar_flux and _k
+  void updateSource();
+
+  /// _scalar_flux from the tallies, then _k and _residual
+  void reduceTallies();
+
+  /// Fission production nu_sigma_f . phi of one FSR, per unit volume
+  Scalar fissionRate(std::size_t fsr) const;
+
+  const unsigned int _num_groups;
+
+  const std::vector<unsigned int> & _fsr_materials;
+
+  const std::vector<MultigroupMaterial<Scalar>> & _materials;
+
+  std::vector<Scalar> _scalar_flux;
+
+  /// What the sweep tallies into: the kernels keep pointers to these and _Q
+  std::vector<Scalar> _tallies;
+  std::vector<Scalar> _fsr_volumes;
+  std::vector<Scalar> _Q;
+
+  /// Fission production of each FSR per unit volume at the last reduction
+  std::vector<Scalar> _fission_rates;
+
+  ThreadedSweep<Scalar, ExpPolicy, SimdWidth, FlatFluxKernel, NumGroups, NumPolar> _sweep;
+
+  Scalar _k = 1;
+
+  Scalar _residual = 0;
+
+  unsigned int _num_iterations = 0;
+
+  SourceIterationTimings _timings;
+};
+
+template <typename Scalar, typename ExpPolicy, unsigned int SimdWidth, unsigned int NumGroups, unsigned int NumPolar>
+SourceIteration<Scalar, ExpPolicy, SimdWidth, NumGroups, NumPolar>::SourceIteration(
+    const SegmentStore & tracks,
+    const std::vector<unsigned int> & fsr_materials,
+    const std::vector<MultigroupMaterial<Scalar>> & materials,
+    unsigned int num_threads,
+    SweepReduction reduction,
+    BoundaryFluxes<Scalar> * boundary_fluxes,
+    unsigned int num_groups,
+    unsigned int num_polar) :
+    _num_groups(num_groups),
+    _fsr_materials(fsr_materials),
+    _materials(materials),
+    _scalar_flux(fsr_materials.size() * num_groups, 1),
+    _tallies(fsr_materials.size() * num_groups, 0),
+    _fsr_volumes(fsr_materials.size(), 0),
+    _Q(fsr_materials.size() * num_groups, 0),
+    _fission_rates(fsr_materials.size(), 0),
+    // ThreadedSweep's default reproducible_blocks
+    _sweep(tracks, _tallies, _fsr_volumes, _Q, materials.size(), num_threads, reduction, 16, num_groups, num_polar)
+{
+  for (unsigned int m = 0; m < materials.size(); m++)
+  {
+    const auto & material = materials[m];
+
+    if (material.sigma_t.size() != num_groups || material.nu_sigma_f.size() != num_groups ||
+        material.chi.size() != num_groups || material.sigma_s.size() != num_groups * num_groups)
+      throw std::invalid_argument("SourceIteration: cross sections need num_groups values per group");
+
+    for (auto sigma_t : material.sigma_t)
+      if (!(sigma_t > 0))
+        throw std::invalid_argument("SourceIteration: sigma_t must be positive");
+
+    _sweep.setSigmaT(m, material.sigma_t.data());
+  }
+
+  for (auto material : fsr_materials)
+    if (material >= materials.size())
+      throw std::invalid_argument("SourceIteration: FSR with an unknown material");
+
+  if (boundary_fluxes)
+    _sweep.setBoundaryFluxes(boundary_fluxes);
+
+  for (std::size_t fsr = 0; fsr < _fsr_materials.size(); fsr++)
+    _fission_rates[fsr] = fissionRate(fsr);
+}
+
+template <typename Scalar, typename ExpPolicy, unsigned int SimdWidth, unsigned int NumGroups, unsigned int NumPolar>
+void
+SourceIteration<Scalar, ExpPolicy, SimdWidth, NumGroups, NumPolar>::iterate()
+{
+  auto start = Clock::now();
+  updateSource();
+  _timings.source += seconds(start);
+
+  start = Clock::now();
+  std::fill(_tallies.begin(), _tallies.end(), 0);
+  std::fill(_fsr_volumes.begin(), _fsr_volumes.end(), 0);
+  _sweep.sweep();
+  _timings.sweep += seconds(start);
+
+  start = Clock::now();
+  reduceTallies();
+  _timings.reduction += seconds(start);
+
+  _num_iterations++;
+}
+
+template <typename Scalar, typename ExpPolicy, unsigned int SimdWidth, unsigned int NumGroups, unsigned int NumPolar>
+bool
+SourceIteration<Scalar, ExpPolicy, SimdWidth, NumGroups, NumPolar>::solve(Scalar tolerance, unsigned int max_iterations)
+{
+  for (unsigned int i = 0; i < max_iterations; i++)
+  {
+    iterate();
+
+    // The first residual compares against the flat guess
+    if (i > 0 && _residual < tolerance)
+      return true;
+  }
+
+  return false;
+}
+
+template <typename Scalar, typename ExpPolicy, unsigned int SimdWidth, unsigned int NumGroups, unsigned int NumPolar>
+void
+SourceIteration<Scalar, ExpPolicy, SimdWidth, NumGroups, NumPolar>::updateSource()
+{
+  const Scalar inverse_four_pi = 1. / (4. * PI);
+
+  for (std::size_t fsr = 0; fsr < _fsr_materials.size(); fsr++)
+  {
+    const auto & material = _materials[_fsr_materials[fsr]];
+
+    const Scalar * phi = &_scalar_flux[fsr * _num_groups];
+    Scalar * Q = &_Q[fsr * _num_groups];
+
+    const Scalar fission = fissionRate(fsr) / _k;
+
+    for (unsigned int g = 0; g < _num_groups; g++)
+      Q[g] = material.chi[g] * fission;
+
+    for (unsigned int from = 0; from < _num_groups; from++)
+    {
+      const Scalar * sigma_s = &material.sigma_s[from * _num_groups];
+
+      for (unsigned int g = 0; g < _num_groups; g++)
+        Q[g] += sigma_s[g] * phi[from];
+    }
+
+    for (unsigned int g = 0; g < _num_groups; g++)
+      Q[g] *= inverse_four_pi / material.sigma_t[g];
+  }
+}
+
+template <typename Scalar, typename ExpPolicy, unsigned int SimdWidth, unsigned int NumGroups, unsigned int NumPolar>
+void
+SourceIteration<Scalar, ExpPolicy, SimdWidth, NumGroups, NumPolar>::reduceTallies()
+{
+  const Scalar four_pi = 4. * PI;
+
+  Scalar old_production = 0, new_production = 0, squared_change = 0;
+  std::size_t fissile_fsrs = 0;
+
+  for (std::size_t fsr = 0; fsr < _fsr_materials.size(); fsr++)
+  {
+    const auto & material = _materials[_fsr_materials[fsr]];
+
+    const Scalar volume = _fsr_volumes[fsr];
+
+    Scalar * phi = &_scalar_flux[fsr * _num_groups];
+    const Scalar * tally = &_tallies[fsr * _num_groups];
+    const Scalar * Q = &_Q[fsr * _num_groups];
+
+    // FSRs no track crosses keep the source's flux
+    for (unsigned int g = 0; g < _num_groups; g++)
+      phi[g] = (volume > 0 ? tally[g] / (material.sigma_t[g] * volume) : 0) + four_pi * Q[g];
+
+    const Scalar old_rate = _fission_rates[fsr];
+    const Scalar new_rate = fissionRate(fsr);
+
+    old_production += old_rate * volume;
+    new_production += new_rate * volume;
+
+    if (old_rate > 0)
+    {
+      squared_change += (new_rate - old_rate) * (new_rate - old_rate) / (old_rate * old_rate);
+      fissile_fsrs++;
+    }
+
+    _fission_rates[fsr] = new_rate;
+  }
+
+  if (old_production > 0)
+    _k *= new_production / old_production;
+
+  _residual = fissile_fsrs ? std::sqrt(squared_change / fissile_fsrs) : 0;
+}
+
+template <typename Scalar, typename ExpPolicy, unsigned int SimdWidth, unsigned int NumGroups, unsigned int NumPolar>
+Scalar
+SourceIteration<Scalar, ExpPolicy, SimdWidth, NumGroups, NumPolar>::fissionRate(std::size_t fsr) const
+{
+  const auto & nu_sigma_f = _materials[_fsr_materials[fsr]].nu_sigma_f;
+
+  const Scalar * phi = &_scalar_flux[fsr * _num_groups];
+
+  Scalar rate = 0;
+  for (unsigned int g = 0; g < _num_groups; g++)
+    rate += nu_sigma_f[g] * phi[g];
+
+  return rate;
+}
+
+#endif /* SOURCEITERATION_H */
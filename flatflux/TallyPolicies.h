@@ -0,0 +1,106 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef TALLYPOLICIES_H
+#define TALLYPOLICIES_H
+
+/**
+ * How FlatFluxKernel adds into the scalar flux and FSR volumes:
+ *
+ *   template <typename TallyScalar, typename Scalar> static void add(TallyScalar * dest, Scalar value);
+ *
+ *   // dest[i] += multiplier * values[i] for the first lanes lanes of a vector class register
+ *   template <typename Scalar, class Vector>
+ *   static void addScaled(Scalar * dest, Scalar multiplier, Vector const & values, unsigned int lanes);
+ *
+ * addScaled() also has to take double dest with float multiplier and
+ * Vec8f / Vec16f values: the tallies of a float kernel kept in double.
+ */
+
+#include "SimdVector.h"
+
+#include <algorithm>
+
+/// Plain read-modify-write: only one kernel may touch an FSR at a time
+struct PlainTally
+{
+  template <typename TallyScalar, typename Scalar>
+  static inline void add(TallyScalar * dest, Scalar value)
+  {
+    *dest += value;
+  }
+
+  template <typename Scalar, class Vector>
+  static inline void addScaled(Scalar * dest, Scalar multiplier, Vector const & values, unsigned int lanes)
+  {
+    Vector current;
+    loadLanes(current, dest, lanes);
+
+    storeLanes(mul_add(multiplier, values, current), dest, lanes);
+  }
+
+  static inline void addScaled(double * dest, float multiplier, Vec8f const & values, unsigned int lanes)
+  {
+    addWidened(dest, multiplier, extend_low(values), extend_high(values), lanes);
+  }
+
+#if MAX_VECTOR_SIZE >= 512
+  static inline void addScaled(double * dest, float multiplier, Vec16f const & values, unsigned int lanes)
+  {
+    addWidened(dest, multiplier, extend_low(values), extend_high(values), lanes);
+  }
+#endif
+
+protected:
+  /// addScaled() of float values widened to the double registers low and high, summed in double
+  template <class Wide>
+  static inline void
+  addWidened(double * dest, double multiplier, Wide const & low, Wide const & high, unsigned int lanes)
+  {
+    const unsigned int width = sizeof(Wide) / sizeof(double);
+
+    addScaled(dest, multiplier, low, std::min(lanes, width));
+
+    if (lanes > width)
+      addScaled(dest + width, multiplier, high, lanes - width);
+  }
+};
+
+/// Every value added with a compare and swap loop, so kernels can share FSRs
+struct AtomicTally
+{
+  template <typename TallyScalar, typename Scalar>
+  static inline void add(TallyScalar * dest, Scalar value)
+  {
+    TallyScalar expected, desired;
+
+    __atomic_load(dest, &expected, __ATOMIC_RELAXED);
+
+    do
+      desired = expected + value;
+    while (!__atomic_compare_exchange(dest, &expected, &desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  }
+
+  template <typename TallyScalar, typename Scalar, class Vector>
+  static inline void addScaled(TallyScalar * dest, Scalar multiplier, Vector const & values, unsigned int lanes)
+  {
+    Scalar scaled[sizeof(Vector) / sizeof(Scalar)];
+    (multiplier * values).store(scaled);
+
+    for (unsigned int i = 0; i < lanes; i++)
+      add(dest + i, scaled[i]);
+  }
+};
+
+#endif /* TALLYPOLICIES_H */
@@ -0,0 +1,497 @@
+/****************************************************************/
+/*               DO NOT MODIFY THIS HEADER                      */
+/* MOOSE - Multiphysics Object Oriented Simulation Environment  */
+/*                                                              */
+/*           (c) 2010 Battelle Energy Alliance, LLC             */
+/*                   ALL RIGHTS RESERVED                        */
+/*                                                              */
+/*          Prepared by Battelle Energy Alliance, LLC           */
+/*            Under Contract No. DE-AC07-05ID14517              */
+/*            With the U. S. Department of Energy               */
+/*                                                              */
+/*            See COPYRIGHT for full restrictions               */
+/****************************************************************/
+
+#ifndef THREADEDSWEEP_H
+#define THREADEDSWEEP_H
+
+#include "BoundaryFluxes.h"
+#include "FlatFluxKernel.h"
+#include "SegmentStore.h"
+
+#include "../pinned_threads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * How the threads of a ThreadedSweep combine their scalar flux and FSR volume tallies
+ */
+enum class SweepReduction
+{
+  /// Every thread tallies into its own copy, summed into the shared arrays after the sweep
+  PRIVATE_BUFFERS,
+  /// Every thread adds straight into the shared arrays with atomic adds
+  ATOMIC,
+  /**
+   * Tracks are swept one color at a time, and tracks of a color never share
+   * an FSR.  Each FSR gets its tallies in color order, then segment order,
+   * whatever the number of threads.
+   */
+  COLORING,
+  /**
+   * The tracks are split into a fixed number of contiguous blocks, each
+   * swept in order into its own copy of the tallies by whichever thread
+   * takes it, and the copies are summed in block order.  Neither order
+   * depends on the number of threads, so the result is the same to the bit.
+   */
+  REPRODUCIBLE
+};
+
+/// "private", "atomic", "coloring" or "reproducible"
+std::string sweepReductionName(SweepReduction reduction);
+
+/**
+ * Greedy coloring of the tracks in store: no two tracks of the same color
+ * cross the same FSR.  Returns the tracks of each color.
+ */
+std::vector<std::vector<std::size_t>> colorTracks(const SegmentStore & store, unsigned int num_fsrs);
+
+/**
+ * Sweeps every track of a SegmentStore with num_threads kernels, one per
+ * thread, handing out tracks to whichever thread is free.  Each
+ * thread sweeps its track forward, then backward.  Both directions of
+ * every track start from the same angular flux (a fresh kernel's), so the
+ * reductions all compute the same sweep and only the order the tallies
+ * are added in can differ.
+ *
+ * Which reduction wins depends on the problem: private buffers cost
+ * num_threads copies of the scalar flux and a reduction that reads all of
+ * them, atomics cost a compare and swap per tally, and coloring costs a
+ * barrier per color and only has as much parallelism as the smallest
+ * colors.  REPRODUCIBLE costs what private buffers do with
+ * reproducible_blocks copies instead of num_threads, and only has
+ * reproducible_blocks blocks to hand out.
+ *
+ * With setBoundaryFluxes() each direction of every track instead starts
+ * from its incoming flux in a BoundaryFluxes and leaves its outgoing flux
+ * there for the next sweep.
+ *
+ * Kernel is the kernel template every thread sweeps with: FlatFluxKernel or
+ * anything with its template parameters, constructor and
+ * onTrack(segments, direction), such as FlattenedFlatFluxKernel.  A
+ * BidirectionalFlatFluxKernel, which sweeps both directions in one call,
+ * is started with both incoming fluxes and leaves both outgoing ones.
+ *
+ * NumGroups and NumPolar are the kernels' compile-time sizes, RUNTIME_SIZE
+ * for sizes only known at run time (see dispatchKernelSizes()); the
+ * constructor's num_groups and num_polar are the actual ones.
+ */
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          template <typename, typename, unsigned int, typename, unsigned int, unsigned int, typename> class Kernel =
+              FlatFluxKernel,
+          unsigned int NumGroups = NUM_GROUPS,
+          unsigned int NumPolar = NUM_POLAR>
+class ThreadedSweep
+{
+public:
+  /**
+   * scalar_flux and Q hold num_groups values per FSR, fsr_volumes one, and
+   * every track carries num_polar * num_groups angular fluxes.  tracks must
+   * outlive the sweep.  reproducible_blocks is the number of blocks
+   * REPRODUCIBLE splits the tracks into: the result only stays the same to
+   * the bit between sweeps that use the same number.
+   */
+  ThreadedSweep(const SegmentStore & tracks,
+                std::vector<Scalar> & scalar_flux,
+                std::vector<Scalar> & fsr_volumes,
+                std::vector<Scalar> & Q,
+                unsigned int num_materials,
+                unsigned int num_threads,
+                SweepReduction reduction,
+                unsigned int reproducible_blocks = 16,
+                unsigned int num_groups = NumGroups,
+                unsigned int num_polar = NumPolar);
+
+  /// Sweep every track once in each direction, adding into the scalar flux and FSR volumes
+  void sweep();
+
+  /**
+   * Start each direction of each track from boundary_fluxes's incoming flux
+   * and store its outgoing one, or go back to the fixed starting flux with
+   * nullptr.  boundary_fluxes must outlive the sweeps and hold angular
+   * fluxes of the kernels' size for every track.
+   */
+  void setBoundaryFluxes(BoundaryFluxes<Scalar> * boundary_fluxes);
+
+  /// Set the numGroups() total cross sections of material in every thread's kernel
+  void setSigmaT(unsigned int material, const Scalar * sigma_t);
+
+  unsigned int numThreads() const { return _threads.numThreads(); }
+
+  unsigned int numGroups() const { return _num_groups; }
+
+  unsigned int numPolar() const { return _num_polar; }
+
+  /// Threads that couldn't be pinned to their core
+  unsigned int numUnpinned() const { return _threads.numUnpinned(); }
+
+  /// Number of colors (0 unless the reduction is COLORING)
+  std::size_t numColors() const { return _colors.size(); }
+
+protected:
+  typedef Kernel<Scalar, ExpPolicy, SimdWidth, PlainTally, NumGroups, NumPolar, Scalar> PlainKernel;
+
+  typedef Kernel<Scalar, ExpPolicy, SimdWidth, AtomicTally, NumGroups, NumPolar, Scalar> AtomicKernel;
+
+  /// Sweep tracks out of track_ids until _next_track runs past the end
+  template <typename ThreadKernel>
+  void sweepTracks(ThreadKernel & kernel, const std::vector<std::size_t> & track_ids);
+
+  /// Sweep blocks of tracks, each with its own kernel, until _next_track runs past the last block
+  void sweepBlocks();
+
+  /// Sweep one track forward, then backward, each from its incoming angular flux
+  template <typename ThreadKernel>
+  void sweepTrack(ThreadKernel & kernel, std::size_t track)
+  {
+    sweepTrack(kernel, track, std::integral_constant<bool, ThreadKernel::sweeps_both_directions>());
+  }
+
+  /// sweepTrack() with one onTrack() call per direction
+  template <typename ThreadKernel>
+  void sweepTrack(ThreadKernel & kernel, std::size_t track, std::false_type);
+
+  /// sweepTrack() with a kernel whose onTrack() sweeps both directions, started and ended together
+  template <typename ThreadKernel>
+  void sweepTrack(ThreadKernel & kernel, std::size_t track, std::true_type);
+
+  /// Sum thread_id's share of every private buffer, in order, into the shared arrays and zero them
+  void reducePrivateBuffers(unsigned int thread_id);
+
+  const SegmentStore & _tracks;
+
+  const SweepReduction _reduction;
+
+  const unsigned int _num_groups;
+
+  const unsigned int _num_polar;
+
+  std::vector<Scalar> & _scalar_flux;
+
+  std::vector<Scalar> & _fsr_volumes;
+
+  PinnedThreads _threads;
+
+  /// Per thread tallies for PRIVATE_BUFFERS, per block for REPRODUCIBLE
+  std::vector<std::vector<Scalar>> _private_scalar_flux;
+  std::vector<std::vector<Scalar>> _private_fsr_volumes;
+
+  /**
+   * One kernel per thread (per block for REPRODUCIBLE): atomic ones for
+   * ATOMIC, plain ones otherwise
+   */
+  std::vector<std::unique_ptr<PlainKernel>> _plain_kernels;
+  std::vector<std::unique_ptr<AtomicKernel>> _atomic_kernels;
+
+  /// Every track, for the reductions that don't color
+  std::vector<std::size_t> _all_tracks;
+
+  std::vector<std::vector<std::size_t>> _colors;
+
+  /// Angular flux every track starts from without boundary fluxes
+  std::vector<Scalar> _incoming_angular_flux;
+
+  /// Incoming and outgoing track fluxes, if set
+  BoundaryFluxes<Scalar> * _boundary_fluxes = nullptr;
+
+  /// Index into the track list being swept of the next track to hand out
+  std::atomic<std::size_t> _next_track;
+};
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          template <typename, typename, unsigned int, typename, unsigned int, unsigned int, typename> class Kernel,
+          unsigned int NumGroups,
+          unsigned int NumPolar>
+ThreadedSweep<Scalar, ExpPolicy, SimdWidth, Kernel, NumGroups, NumPolar>::ThreadedSweep(
+    const SegmentStore & tracks,
+    std::vector<Scalar> & scalar_flux,
+    std::vector<Scalar> & fsr_volumes,
+    std::vector<Scalar> & Q,
+    unsigned int num_materials,
+    unsigned int num_threads,
+    SweepReduction reduction,
+    unsigned int reproducible_blocks,
+    unsigned int num_groups,
+    unsigned int num_polar) :
+    _tracks(tracks),
+    _reduction(reduction),
+    _num_groups(num_groups),
+    _num_polar(num_polar),
+    _scalar_flux(scalar_flux),
+    _fsr_volumes(fsr_volumes),
+    _threads(num_threads),
+    _next_track(0)
+{
+  if (_reduction == SweepReduction::COLORING)
+    _colors = colorTracks(_tracks, _fsr_volumes.size());
+  else
+    for (std::size_t t = 0; t < _tracks.numTracks(); t++)
+      _all_tracks.push_back(t);
+
+  const unsigned int num_kernels =
+      _reduction == SweepReduction::REPRODUCIBLE ? std::max(reproducible_blocks, 1u) : _threads.numThreads();
+
+  if (_reduction == SweepReduction::PRIVATE_BUFFERS || _reduction == SweepReduction::REPRODUCIBLE)
+  {
+    _private_scalar_flux.resize(num_kernels);
+    _private_fsr_volumes.resize(num_kernels);
+  }
+
+  _plain_kernels.resize(num_kernels);
+  _atomic_kernels.resize(num_kernels);
+
+  // Each thread builds its own kernels and buffers so it first touches them
+  _threads.run([this, &Q, num_materials, num_kernels](unsigned int thread_id)
+               {
+                 for (unsigned int k = thread_id; k < num_kernels; k += _threads.numThreads())
+                   switch (_reduction)
+                   {
+                     case SweepReduction::PRIVATE_BUFFERS:
+                     case SweepReduction::REPRODUCIBLE:
+                       _private_scalar_flux[k].assign(_scalar_flux.size(), 0);
+                       _private_fsr_volumes[k].assign(_fsr_volumes.size(), 0);
+                       _plain_kernels[k].reset(
+                           new PlainKernel(_private_scalar_flux[k],
+                                           _private_fsr_volumes[k],
+                                           Q,
+                                           num_materials,
+                                           _num_groups,
+                                           _num_polar));
+                       break;
+                     case SweepReduction::ATOMIC:
+                       _atomic_kernels[k].reset(
+                           new AtomicKernel(_scalar_flux, _fsr_volumes, Q, num_materials, _num_groups, _num_polar));
+                       break;
+                     case SweepReduction::COLORING:
+                       _plain_kernels[k].reset(
+                           new PlainKernel(_scalar_flux, _fsr_volumes, Q, num_materials, _num_groups, _num_polar));
+                       break;
+                   }
+               });
+
+  // Whatever a fresh kernel starts with
+  const Scalar * initial_angular_flux = _reduction == SweepReduction::ATOMIC ? _atomic_kernels[0]->angularFlux()
+                                                                              : _plain_kernels[0]->angularFlux();
+  const unsigned int angular_flux_size = _reduction == SweepReduction::ATOMIC ? _atomic_kernels[0]->angularFluxSize()
+                                                                               : _plain_kernels[0]->angularFluxSize();
+
+  _incoming_angular_flux.assign(initial_angular_flux, initial_angular_flux + angular_flux_size);
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          template <typename, typename, unsigned int, typename, unsigned int, unsigned int, typename> class Kernel,
+          unsigned int NumGroups,
+          unsigned int NumPolar>
+void
+ThreadedSweep<Scalar, ExpPolicy, SimdWidth, Kernel, NumGroups, NumPolar>::sweep()
+{
+  switch (_reduction)
+  {
+    case SweepReduction::PRIVATE_BUFFERS:
+      _next_track = 0;
+      _threads.run([this](unsigned int thread_id) { sweepTracks(*_plain_kernels[thread_id], _all_tracks); });
+      _threads.run([this](unsigned int thread_id) { reducePrivateBuffers(thread_id); });
+      break;
+
+    case SweepReduction::ATOMIC:
+      _next_track = 0;
+      _threads.run([this](unsigned int thread_id) { sweepTracks(*_atomic_kernels[thread_id], _all_tracks); });
+      break;
+
+    case SweepReduction::COLORING:
+      // Finishing every track of a color before starting the next is what keeps the plain adds safe
+      for (const auto & color : _colors)
+      {
+        _next_track = 0;
+        _threads.run([this, &color](unsigned int thread_id) { sweepTracks(*_plain_kernels[thread_id], color); });
+      }
+      break;
+
+    case SweepReduction::REPRODUCIBLE:
+      _next_track = 0;
+      _threads.run([this](unsigned int) { sweepBlocks(); });
+      _threads.run([this](unsigned int thread_id) { reducePrivateBuffers(thread_id); });
+      break;
+  }
+
+  if (_boundary_fluxes)
+    _boundary_fluxes->swap();
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          template <typename, typename, unsigned int, typename, unsigned int, unsigned int, typename> class Kernel,
+          unsigned int NumGroups,
+          unsigned int NumPolar>
+void
+ThreadedSweep<Scalar, ExpPolicy, SimdWidth, Kernel, NumGroups, NumPolar>::setBoundaryFluxes(
+    BoundaryFluxes<Scalar> * boundary_fluxes)
+{
+  if (boundary_fluxes &&
+      (boundary_fluxes->numTracks() != _tracks.numTracks() ||
+       boundary_fluxes->angularFluxSize() != _incoming_angular_flux.size()))
+    throw std::invalid_argument("ThreadedSweep: boundary fluxes don't match the tracks / kernels");
+
+  _boundary_fluxes = boundary_fluxes;
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          template <typename, typename, unsigned int, typename, unsigned int, unsigned int, typename> class Kernel,
+          unsigned int NumGroups,
+          unsigned int NumPolar>
+void
+ThreadedSweep<Scalar, ExpPolicy, SimdWidth, Kernel, NumGroups, NumPolar>::setSigmaT(
+    unsigned int material, const Scalar * sigma_t)
+{
+  for (auto & kernel : _plain_kernels)
+    if (kernel)
+      std::copy(sigma_t, sigma_t + kernel->numGroups(), kernel->sigmaT().row(material));
+
+  for (auto & kernel : _atomic_kernels)
+    if (kernel)
+      std::copy(sigma_t, sigma_t + kernel->numGroups(), kernel->sigmaT().row(material));
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          template <typename, typename, unsigned int, typename, unsigned int, unsigned int, typename> class Kernel,
+          unsigned int NumGroups,
+          unsigned int NumPolar>
+template <typename ThreadKernel>
+void
+ThreadedSweep<Scalar, ExpPolicy, SimdWidth, Kernel, NumGroups, NumPolar>::sweepTracks(
+    ThreadKernel & kernel, const std::vector<std::size_t> & track_ids)
+{
+  for (std::size_t i = _next_track++; i < track_ids.size(); i = _next_track++)
+    sweepTrack(kernel, track_ids[i]);
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          template <typename, typename, unsigned int, typename, unsigned int, unsigned int, typename> class Kernel,
+          unsigned int NumGroups,
+          unsigned int NumPolar>
+void
+ThreadedSweep<Scalar, ExpPolicy, SimdWidth, Kernel, NumGroups, NumPolar>::sweepBlocks()
+{
+  const std::size_t num_blocks = _plain_kernels.size();
+  const std::size_t num_tracks = _all_tracks.size();
+
+  for (std::size_t block = _next_track++; block < num_blocks; block = _next_track++)
+    for (std::size_t i = block * num_tracks / num_blocks; i < (block + 1) * num_tracks / num_blocks; i++)
+      sweepTrack(*_plain_kernels[block], _all_tracks[i]);
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          template <typename, typename, unsigned int, typename, unsigned int, unsigned int, typename> class Kernel,
+          unsigned int NumGroups,
+          unsigned int NumPolar>
+template <typename ThreadKernel>
+void
+ThreadedSweep<Scalar, ExpPolicy, SimdWidth, Kernel, NumGroups, NumPolar>::sweepTrack(
+    ThreadKernel & kernel, std::size_t track, std::false_type)
+{
+  const SegmentList segments = _tracks.track(track);
+
+  for (auto direction : {TrackDirection::FORWARD, TrackDirection::BACKWARD})
+  {
+    if (_boundary_fluxes)
+      kernel.startTrack(_boundary_fluxes->incoming(track, direction));
+    else
+      kernel.startTrack(_incoming_angular_flux.data());
+
+    kernel.onTrack(segments, direction);
+
+    if (_boundary_fluxes)
+      if (Scalar * outgoing = _boundary_fluxes->outgoing(track, direction))
+        std::copy(kernel.angularFlux(), kernel.angularFlux() + kernel.angularFluxSize(), outgoing);
+  }
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          template <typename, typename, unsigned int, typename, unsigned int, unsigned int, typename> class Kernel,
+          unsigned int NumGroups,
+          unsigned int NumPolar>
+template <typename ThreadKernel>
+void
+ThreadedSweep<Scalar, ExpPolicy, SimdWidth, Kernel, NumGroups, NumPolar>::sweepTrack(
+    ThreadKernel & kernel, std::size_t track, std::true_type)
+{
+  if (_boundary_fluxes)
+    kernel.startTrack(_boundary_fluxes->incoming(track, TrackDirection::FORWARD),
+                      _boundary_fluxes->incoming(track, TrackDirection::BACKWARD));
+  else
+    kernel.startTrack(_incoming_angular_flux.data(), _incoming_angular_flux.data());
+
+  kernel.onTrack(_tracks.track(track));
+
+  if (_boundary_fluxes)
+  {
+    if (Scalar * outgoing = _boundary_fluxes->outgoing(track, TrackDirection::FORWARD))
+      std::copy(kernel.angularFlux(), kernel.angularFlux() + kernel.angularFluxSize(), outgoing);
+
+    if (Scalar * outgoing = _boundary_fluxes->outgoing(track, TrackDirection::BACKWARD))
+      std::copy(kernel.backwardAngularFlux(), kernel.backwardAngularFlux() + kernel.angularFluxSize(), outgoing);
+  }
+}
+
+template <typename Scalar,
+          typename ExpPolicy,
+          unsigned int SimdWidth,
+          template <typename, typename, unsigned int, typename, unsigned int, unsigned int, typename> class Kernel,
+          unsigned int NumGroups,
+          unsigned int NumPolar>
+void
+ThreadedSweep<Scalar, ExpPolicy, SimdWidth, Kernel, NumGroups, NumPolar>::reducePrivateBuffers(unsigned int thread_id)
+{
+  const unsigned int num_threads = _threads.numThreads();
+
+  auto reduce = [thread_id, num_threads](std::vector<Scalar> & shared, std::vector<std::vector<Scalar>> & buffers)
+  {
+    // Contiguous ranges per thread
+    const std::size_t begin = thread_id * shared.size() / num_threads;
+    const std::size_t end = (thread_id + 1) * shared.size() / num_threads;
+
+    for (auto & buffer : buffers)
+      for (std::size_t i = begin; i < end; i++)
+      {
+        shared[i] += buffer[i];
+        buffer[i] = 0;
+      }
+  };
+
+  reduce(_scalar_flux, _private_scalar_flux);
+  reduce(_fsr_volumes, _private_fsr_volumes);
+}
+
+#endif /* THREADEDSWEEP_H */
@@ -3,6 +3,10 @@
 
 #define NUM_GROUPS 32
 #define NUM_POLAR 3
+
+// Kernel group / polar angle count given at run time instead of compile time
+#define RUNTIME_SIZE 0
+
 #define PI 3.1415926535
 
 #define Real double
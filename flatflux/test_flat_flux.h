@@ -1,6 +0,0 @@
-#ifndef TEST_FLAT_FLUX_H
-#define TEST_FLAT_FLUX_H
-
-void test_flat_flux();
-
-#endif
@@ -6,13 +6,21 @@
 #include <cmath>
 #include <chrono>
 
-#define MAX_VECTOR_SIZE 256
+#define MAX_VECTOR_SIZE 512
 
 #include "vecmath/vectorclass.h"
 #include "vecmath/vectormath_exp.h"
 
+#include "exp_tiers.h"
+#include "exp_attenuation.h"
+#include "exp_nonpositive.h"
+#include "exp_table.h"
+#include "exp_fixed.h"
+
 #include "fmath/fmath.h"
 
+#include "exp_dispatch.h"
+
 #define Real double
 #define VecSize 4
 #define NumValues 32
@@ -21,8 +29,35 @@ void normalExp(std::vector<Real> & vec, std::vector<Real> & out_vec);
 void valarrayExp(std::vector<Real> & vec, std::vector<Real> & out_vec);
 void fmathExp(std::vector<Real> & vec, std::vector<Real> & out_vec);
 void vectorizedExp(std::vector<Real> & vec, std::vector<Real> & out_vec);
+void vectorized8Exp(std::vector<Real> & vec, std::vector<Real> & out_vec);
+void dispatchedExp(std::vector<Real> & vec, std::vector<Real> & out_vec);
 void mklExp(std::vector<Real> & vec, std::vector<Real> & out_vec);
 
+/**
+ * Vec8d exp with a relative error below 10^-Digits (see exp_tiers.h).
+ * Instantiated in impls.C for Digits = 5, 7, 10, 13 and 15.
+ */
+template <int Digits>
+void tieredExp(std::vector<Real> & vec, std::vector<Real> & out_vec);
+
+/**
+ * Vec8d exp that requires vec[i] <= 0 (see exp_nonpositive.h).  On 32
+ * values with AVX-512 and gcc 12 it measured no faster than vectorized8 on
+ * the same input: medians of 35-39 ns against 30-33 ns over three runs of
+ * impls/nonpositive and impls/nonpositive_vectorized8.
+ */
+void nonpositiveExp(std::vector<Real> & vec, std::vector<Real> & out_vec);
+
+/**
+ * out_vec[i] = 1 - exp(-vec[i]) in one pass, for vec[i] >= 0 (see exp_attenuation.h)
+ */
+void oneMinusExpNeg(std::vector<Real> & vec, std::vector<Real> & out_vec);
+
+/**
+ * out_vec[i] = 1 - exp(-vec[i]) interpolated from table, for vec[i] >= 0
+ */
+void tableOneMinusExpNeg(const ExpTable & table, std::vector<Real> & vec, std::vector<Real> & out_vec);
+
 #ifdef USE_IPP
 void ippExp(std::vector<Real> & vec, std::vector<Real> & out_vec);
 #endif
@@ -0,0 +1,66 @@
+#ifndef PARALLEL_EXP_H
+#define PARALLEL_EXP_H
+
+#include "pinned_threads.h"
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * Thread parallel exp over very large arrays.
+ *
+ * Work is split into cache sized chunks and every thread always owns the same
+ * contiguous range of chunks for a given array size.  Arrays obtained from
+ * allocate() are first touched by the owning threads, so on a NUMA machine
+ * each thread's pages live on its own node.  Threads are pinned to one core
+ * each for the lifetime of the object.
+ *
+ * exp() is reentrant with respect to other ParallelExp objects, but a single
+ * object only runs one call at a time.
+ */
+class ParallelExp
+{
+public:
+  /**
+   * @param num_threads Number of worker threads (pinned to cores 0..num_threads-1)
+   * @param chunk_size Number of values each thread processes at a time
+   */
+  ParallelExp(unsigned int num_threads, std::size_t chunk_size = 4096);
+
+  ParallelExp(const ParallelExp &) = delete;
+  ParallelExp & operator=(const ParallelExp &) = delete;
+
+  /**
+   * out[i] = exp(in[i]) for size values
+   */
+  void exp(const double * in, double * out, std::size_t size);
+
+  /**
+   * Allocate a zeroed array of size doubles.  Every page is first touched by
+   * the thread that will process it in exp()
+   */
+  double * allocate(std::size_t size);
+
+  /**
+   * Release an array from allocate()
+   */
+  static void deallocate(double * array);
+
+  unsigned int numThreads() const { return _threads.numThreads(); }
+
+  /// Threads that couldn't be pinned to their core
+  unsigned int numUnpinned() const { return _threads.numUnpinned(); }
+
+protected:
+  /// Run work(thread_id, begin, end) on every thread over its part of [0, size)
+  void run(std::size_t size, const std::function<void(std::size_t, std::size_t)> & work);
+
+  /// Range of values owned by thread_id for an array of size values
+  void ownedRange(unsigned int thread_id, std::size_t size, std::size_t & begin, std::size_t & end) const;
+
+  const std::size_t _chunk_size;
+
+  PinnedThreads _threads;
+};
+
+#endif
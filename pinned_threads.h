@@ -0,0 +1,60 @@
+#ifndef PINNED_THREADS_H
+#define PINNED_THREADS_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Worker threads pinned to cores 0..num_threads-1 for the lifetime of the
+ * object, that all run the same job.  A thread that can't be pinned (or
+ * any thread off Linux) still runs, but is reported on stderr and counted
+ * in numUnpinned().
+ *
+ * A single object only runs one job at a time.
+ */
+class PinnedThreads
+{
+public:
+  explicit PinnedThreads(unsigned int num_threads);
+  ~PinnedThreads();
+
+  PinnedThreads(const PinnedThreads &) = delete;
+  PinnedThreads & operator=(const PinnedThreads &) = delete;
+
+  /// Run work(thread_id) on every thread and wait for all of them
+  void run(const std::function<void(unsigned int)> & work);
+
+  unsigned int numThreads() const { return _num_threads; }
+
+  /// Threads left to float between cores
+  unsigned int numUnpinned() const { return _num_unpinned; }
+
+protected:
+  void workerLoop(unsigned int thread_id);
+
+  const unsigned int _num_threads;
+
+  unsigned int _num_unpinned = 0;
+
+  std::vector<std::thread> _threads;
+
+  std::mutex _mutex;
+
+  std::condition_variable _work_ready;
+
+  std::condition_variable _work_done;
+
+  /// Bumped for every job so the workers know there is something new to do
+  unsigned long _generation = 0;
+
+  unsigned int _num_finished = 0;
+
+  bool _shutdown = false;
+
+  const std::function<void(unsigned int)> * _job = nullptr;
+};
+
+#endif
@@ -870,7 +870,7 @@ template <typename T>
 inline
 bool VectorizedTypeVector<T>::absolute_fuzzy_equals(const VectorizedTypeVector<T> & rhs, Real tol) const
 {
-  return abs(_coords - rhs._coords) <= tol;
+  return horizontal_add(abs(_coords - rhs._coords)) <= tol;
 }
 
 
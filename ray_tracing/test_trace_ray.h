@@ -1,6 +0,0 @@
-#ifndef TEST_TRACE_RAY_H
-#define TEST_TRACE_RAY_H
-
-void test_trace_ray();
-
-#endif
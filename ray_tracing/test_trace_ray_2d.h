@@ -1,6 +0,0 @@
-#ifndef TEST_TRACE_RAY_2D_H
-#define TEST_TRACE_RAY_2D_H
-
-void test_trace_ray_2d();
-
-#endif
@@ -1,6 +0,0 @@
-#ifndef TEST_IMPLS
-#define TEST_IMPLS
-
-void test_impls();
-
-#endif
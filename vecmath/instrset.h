@@ -54,6 +54,13 @@
 #endif // INSTRSET
 
 // Include the appropriate header file for intrinsic functions
+#if defined (__GNUC__) && ! defined (__INTEL_COMPILER) && ! defined (__clang__)
+// g++ 12 reports the _mm512_undefined_* pass-through operands of the AVX-512
+// intrinsics as uninitialized wherever they inline (GCC bug 105593)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
 #if INSTRSET > 7                       // AVX2 and later
 #if defined (__GNUC__) && ! defined (__INTEL_COMPILER)
 #include <x86intrin.h>                 // x86intrin.h includes header files for whatever instruction 
@@ -77,6 +84,9 @@
 #elif INSTRSET == 1
 #include <xmmintrin.h>                 // SSE
 #endif // INSTRSET
+#if defined (__GNUC__) && ! defined (__INTEL_COMPILER) && ! defined (__clang__)
+#pragma GCC diagnostic pop
+#endif
 
 #if INSTRSET >= 8 && !defined(__FMA__)
 // Assume that all processors that have AVX2 also have FMA3
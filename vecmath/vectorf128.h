@@ -511,10 +511,11 @@ public:
         switch (n) {
         case 1:
             xmm = _mm_load_ss(p); break;
+        // Through __m64, which may alias: the floats read as a double broke strict aliasing
         case 2:
-            xmm = _mm_castpd_ps(_mm_load_sd((double const*)p)); break;
+            xmm = _mm_loadl_pi(_mm_setzero_ps(), (__m64 const*)p); break;
         case 3:
-            t1 = _mm_castpd_ps(_mm_load_sd((double const*)p));
+            t1 = _mm_loadl_pi(_mm_setzero_ps(), (__m64 const*)p);
             t2 = _mm_load_ss(p + 2);
             xmm = _mm_movelh_ps(t1, t2); break;
         case 4:
@@ -531,9 +532,9 @@ public:
         case 1:
             _mm_store_ss(p, xmm); break;
         case 2:
-            _mm_store_sd((double*)p, _mm_castps_pd(xmm)); break;
+            _mm_storel_pi((__m64*)p, xmm); break;
         case 3:
-            _mm_store_sd((double*)p, _mm_castps_pd(xmm));
+            _mm_storel_pi((__m64*)p, xmm);
             t1 = _mm_movehl_ps(xmm,xmm);
             _mm_store_ss(p + 2, t1); break;
         case 4:
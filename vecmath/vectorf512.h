@@ -420,8 +420,7 @@ public:
     }
     // Member function to change a single element in vector
     Vec16f const & insert(uint32_t index, float value) {
-        //zmm = _mm512_mask_set1_ps(zmm, __mmask16(1 << index), value);  // this intrinsic function does not exist (yet?)
-        zmm = _mm512_castsi512_ps(_mm512_mask_set1_epi32(_mm512_castps_si512(zmm), __mmask16(1 << index), *(int32_t*)&value));  // ignore warning
+        zmm = _mm512_mask_broadcastss_ps(zmm, __mmask16(1 << index), _mm_set_ss(value));
         return *this;
     }
     // Member function extract a single element from vector
@@ -1091,8 +1090,7 @@ public:
     // Member function to change a single element in vector
     // Note: This function is inefficient. Use load function if changing more than one element
     Vec8d const & insert(uint32_t index, double value) {
-        //zmm = _mm512_mask_set1_pd(zmm, __mmask16(1 << index), value);  // this intrinsic function does not exist (yet?)
-        zmm = _mm512_castsi512_pd(_mm512_mask_set1_epi64(_mm512_castpd_si512(zmm), __mmask16(1 << index), *(int64_t*)&value)); // ignore warning
+        zmm = _mm512_mask_broadcastsd_pd(zmm, __mmask8(1 << index), _mm_set_sd(value));
         return *this;
     }
     // Member function extract a single element from vector